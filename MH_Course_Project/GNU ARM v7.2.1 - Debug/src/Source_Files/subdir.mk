@@ -7,40 +7,76 @@ C_SRCS += \
 ../src/Source_Files/HW_delay.c \
 ../src/Source_Files/Si7021.c \
 ../src/Source_Files/app.c \
+../src/Source_Files/background.c \
 ../src/Source_Files/ble.c \
 ../src/Source_Files/cmu.c \
+../src/Source_Files/dcdc.c \
+../src/Source_Files/energy.c \
+../src/Source_Files/energy_model.c \
+../src/Source_Files/event_queue.c \
 ../src/Source_Files/gpio.c \
+../src/Source_Files/hibernate.c \
 ../src/Source_Files/i2c.c \
 ../src/Source_Files/letimer.c \
 ../src/Source_Files/leuart.c \
+../src/Source_Files/perf.c \
 ../src/Source_Files/scheduler.c \
-../src/Source_Files/sleep_routines.c 
+../src/Source_Files/sleep_routines.c \
+../src/Source_Files/sw_timer.c \
+../src/Source_Files/sweep.c \
+../src/Source_Files/task.c \
+../src/Source_Files/trace.c \
+../src/Source_Files/watchdog.c 
 
 OBJS += \
 ./src/Source_Files/HW_delay.o \
 ./src/Source_Files/Si7021.o \
 ./src/Source_Files/app.o \
+./src/Source_Files/background.o \
 ./src/Source_Files/ble.o \
 ./src/Source_Files/cmu.o \
+./src/Source_Files/dcdc.o \
+./src/Source_Files/energy.o \
+./src/Source_Files/energy_model.o \
+./src/Source_Files/event_queue.o \
 ./src/Source_Files/gpio.o \
+./src/Source_Files/hibernate.o \
 ./src/Source_Files/i2c.o \
 ./src/Source_Files/letimer.o \
 ./src/Source_Files/leuart.o \
+./src/Source_Files/perf.o \
 ./src/Source_Files/scheduler.o \
-./src/Source_Files/sleep_routines.o 
+./src/Source_Files/sleep_routines.o \
+./src/Source_Files/sw_timer.o \
+./src/Source_Files/sweep.o \
+./src/Source_Files/task.o \
+./src/Source_Files/trace.o \
+./src/Source_Files/watchdog.o 
 
 C_DEPS += \
 ./src/Source_Files/HW_delay.d \
 ./src/Source_Files/Si7021.d \
 ./src/Source_Files/app.d \
+./src/Source_Files/background.d \
 ./src/Source_Files/ble.d \
 ./src/Source_Files/cmu.d \
+./src/Source_Files/dcdc.d \
+./src/Source_Files/energy.d \
+./src/Source_Files/energy_model.d \
+./src/Source_Files/event_queue.d \
 ./src/Source_Files/gpio.d \
+./src/Source_Files/hibernate.d \
 ./src/Source_Files/i2c.d \
 ./src/Source_Files/letimer.d \
 ./src/Source_Files/leuart.d \
+./src/Source_Files/perf.d \
 ./src/Source_Files/scheduler.d \
-./src/Source_Files/sleep_routines.d 
+./src/Source_Files/sleep_routines.d \
+./src/Source_Files/sw_timer.d \
+./src/Source_Files/sweep.d \
+./src/Source_Files/task.d \
+./src/Source_Files/trace.d \
+./src/Source_Files/watchdog.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -65,6 +101,13 @@ src/Source_Files/app.o: ../src/Source_Files/app.c
 	@echo 'Finished building: $<'
 	@echo ' '
 
+src/Source_Files/background.o: ../src/Source_Files/background.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/background.d" -MT"src/Source_Files/background.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
 src/Source_Files/ble.o: ../src/Source_Files/ble.c
 	@echo 'Building file: $<'
 	@echo 'Invoking: GNU ARM C Compiler'
@@ -79,6 +122,34 @@ src/Source_Files/cmu.o: ../src/Source_Files/cmu.c
 	@echo 'Finished building: $<'
 	@echo ' '
 
+src/Source_Files/dcdc.o: ../src/Source_Files/dcdc.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/dcdc.d" -MT"src/Source_Files/dcdc.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/Source_Files/energy.o: ../src/Source_Files/energy.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/energy.d" -MT"src/Source_Files/energy.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/Source_Files/energy_model.o: ../src/Source_Files/energy_model.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/energy_model.d" -MT"src/Source_Files/energy_model.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/Source_Files/event_queue.o: ../src/Source_Files/event_queue.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/event_queue.d" -MT"src/Source_Files/event_queue.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
 src/Source_Files/gpio.o: ../src/Source_Files/gpio.c
 	@echo 'Building file: $<'
 	@echo 'Invoking: GNU ARM C Compiler'
@@ -86,6 +157,13 @@ src/Source_Files/gpio.o: ../src/Source_Files/gpio.c
 	@echo 'Finished building: $<'
 	@echo ' '
 
+src/Source_Files/hibernate.o: ../src/Source_Files/hibernate.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/hibernate.d" -MT"src/Source_Files/hibernate.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
 src/Source_Files/i2c.o: ../src/Source_Files/i2c.c
 	@echo 'Building file: $<'
 	@echo 'Invoking: GNU ARM C Compiler'
@@ -107,6 +185,13 @@ src/Source_Files/leuart.o: ../src/Source_Files/leuart.c
 	@echo 'Finished building: $<'
 	@echo ' '
 
+src/Source_Files/perf.o: ../src/Source_Files/perf.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/perf.d" -MT"src/Source_Files/perf.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
 src/Source_Files/scheduler.o: ../src/Source_Files/scheduler.c
 	@echo 'Building file: $<'
 	@echo 'Invoking: GNU ARM C Compiler'
@@ -121,4 +206,38 @@ src/Source_Files/sleep_routines.o: ../src/Source_Files/sleep_routines.c
 	@echo 'Finished building: $<'
 	@echo ' '
 
+src/Source_Files/sw_timer.o: ../src/Source_Files/sw_timer.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/sw_timer.d" -MT"src/Source_Files/sw_timer.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/Source_Files/sweep.o: ../src/Source_Files/sweep.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/sweep.d" -MT"src/Source_Files/sweep.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/Source_Files/task.o: ../src/Source_Files/task.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/task.d" -MT"src/Source_Files/task.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/Source_Files/trace.o: ../src/Source_Files/trace.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/trace.d" -MT"src/Source_Files/trace.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/Source_Files/watchdog.o: ../src/Source_Files/watchdog.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m4 -mthumb -std=c99 '-DEFM32PG12B500F1024GL125=1' '-DDEBUG_EFM=1' -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/CMSIS/Include" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Source_Files" -I"C:\Users\Matt Hartnett\SimplicityStudio\v4_workspace\MH_Course_Project\src\Header_Files" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/bsp" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/emlib/inc" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/common/drivers" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//platform/Device/SiliconLabs/EFM32PG12B/Include" -I"C:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7//hardware/kit/SLSTK3402A_EFM32PG12/config" -O2 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -mfpu=fpv4-sp-d16 -mfloat-abi=softfp -MMD -MP -MF"src/Source_Files/watchdog.d" -MT"src/Source_Files/watchdog.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
 
@@ -16,6 +16,8 @@
 #include "scheduler.h"
 #include "sleep_routines.h"
 #include "i2c.h"
+#include "sw_timer.h"
+#include "brd_config.h"
 
 //***********************************************************************************
 // defined files
@@ -41,11 +43,16 @@
 #define		I2C_clhr		i2cClockHLRAsymetric
 #define		temp_noHold	0xF3
 #define		slave_address	0x40
+#define		SI7021_POWERUP_MS	80		// Longest time from power on until the Si7021 answers
+#define		SI7021_MAX_HOLD_MS	100		// Longest the power up wait should keep EM3 blocked
 //***********************************************************************************
 // function prototypes
 //***********************************************************************************
-void si7021_i2c_open(uint32_t si7021_read_cb);
+void si7021_i2c_open(uint32_t si7021_read_cb, uint32_t si7021_power_cb);
 void si7021_i2c_read(uint32_t si7021_read_cb);
+void si7021_powered(void);
+bool si7021_busy(void);
 float si7021_temp(void);
+float si7021_temp_convert(uint32_t code);
 
 #endif
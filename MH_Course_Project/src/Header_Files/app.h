@@ -18,6 +18,16 @@
 #include "brd_config.h"
 #include "Si7021.h"
 #include "ble.h"
+#include "sw_timer.h"
+#include "task.h"
+#include "trace.h"
+#include "watchdog.h"
+#include "background.h"
+#include "hibernate.h"
+#include "energy.h"
+#include "perf.h"
+#include "dcdc.h"
+#include "sweep.h"
 #include "HW_Delay.h"
 
 
@@ -28,28 +38,35 @@
 #define		PWM_ACT_PER			0.15	// PWM active period in seconds
 #define		PWM_ROUTE_0			LETIMER_ROUTELOC0_OUT0LOC_LOC28
 #define 	PWM_ROUTE_1			LETIMER_ROUTELOC0_OUT1LOC_LOC28
-// Application scheduled events
-#define LETIMER0_COMP0_CB		0x00000001	//0b00001
-#define LETIMER0_COMP1_CB		0x00000002	//0b00010
-#define LETIMER0_UF_CB			0x00000004	//0b00100
-#define	SI7021_READ_CB			0x00000008  //0b01000
-#define BOOT_UP_CB				0x00000010  //0b10000
-#define BLE_TX_CB				0x00000020
-#define BLE_RX_CB				0x00000040
 
 #define SYSTEM_BLOCK_EM			EM3
 
+#define	APP_WDOG_SLACK_MS		500		// Jitter allowed on each supervised cycle
+#define	APP_WDOG_PERIOD_MS		((uint32_t)(PWM_PER * 1000) + APP_WDOG_SLACK_MS)
+
+#define	APP_STATS_SLICE			8		// Events added up by each slice of the stats job
+
 //#define BLE_TEST_ENABLED
 
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+// Writes the next line of a BLE report to str and advances line, returns false when done
+typedef bool (*APP_REPORT)(uint32_t *line, char *str);
+
 //***********************************************************************************
 // function prototypes
 //***********************************************************************************
 void app_peripheral_setup(void);
+void app_wake_setup(void);
+uint32_t app_idle_ms(void);
 void scheduled_letimer0_uf_cb (void);
 void scheduled_letimer0_comp0_cb (void);
 void scheduled_letimer0_comp1_cb (void);
 void si7021_temp_done_evt(void);
+void scheduled_si7021_power_cb (void);
 void scheduled_boot_up_cb (void);
+void scheduled_sweep_cb (void);
 void scheduled_ble_rx_cb (void);
 void scheduled_ble_tx_cb (void);
 #endif
@@ -0,0 +1,60 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	ATOMIC_HG
+#define	ATOMIC_HG
+
+/* System include statements */
+#include <stdint.h>
+
+/* Silicon Labs include statements */
+#include "em_device.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+
+/*
+ * Read-modify-write of one word without masking interrupts, using the Cortex-M4
+ * exclusive load and store. If an interrupt runs between the load and the store
+ * the exclusive monitor is cleared, the store fails and the operation is simply
+ * retried with the new value, so the interrupt is never delayed. Each function
+ * returns the value the word held before the operation. They are defined in the
+ * header so that they are inlined into the interrupt paths that use them.
+ */
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+static inline uint32_t atomic_word_or(volatile uint32_t *word, uint32_t mask){
+	uint32_t old;
+
+	do {
+		old = __LDREXW(word);
+	} while(__STREXW(old | mask, word));
+	return old;
+}
+
+static inline uint32_t atomic_word_and(volatile uint32_t *word, uint32_t mask){
+	uint32_t old;
+
+	do {
+		old = __LDREXW(word);
+	} while(__STREXW(old & mask, word));
+	return old;
+}
+
+static inline uint32_t atomic_word_add(volatile uint32_t *word, uint32_t value){
+	uint32_t old;
+
+	do {
+		old = __LDREXW(word);
+	} while(__STREXW(old + value, word));
+	return old;
+}
+
+#endif
@@ -0,0 +1,54 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	BACKGROUND_HG
+#define	BACKGROUND_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Silicon Labs include statements */
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "scheduler.h"
+#include "sleep_routines.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	BACKGROUND_MARGIN_US		100		// Time left before a deadline to wake up for it
+#define	BACKGROUND_FIRST_SLICE		1000	// Assumed cycles of a job's first slice
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct BG_JOB BG_JOB;
+
+// Runs one slice of a background job, returns true once the job has finished
+typedef bool (*BG_SLICE)(BG_JOB *job);
+
+struct BG_JOB {
+	BG_JOB				*next;			// next job in the queue
+	BG_SLICE			fn;				// runs one slice of the job
+	uint32_t			step;			// progress of the job, kept across slices
+	uint32_t			slice_max;		// longest slice in cycles, predicts the next one
+	uint32_t			slices;			// slices run
+	uint32_t			skipped;		// slices put off because a deadline was too close
+	bool				queued;			// job is waiting in the queue
+};
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void background_open(void);
+void background_clock_set(uint32_t core_hz);
+void background_submit(BG_JOB *job, BG_SLICE fn);
+bool background_run(uint32_t idle_ms);
+bool background_pending(void);
+
+#endif
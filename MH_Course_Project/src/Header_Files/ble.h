@@ -58,6 +58,7 @@ typedef	struct {
 //***********************************************************************************
 void ble_open(uint32_t tx_event, uint32_t rx_event);
 void ble_write(char *string);
+bool ble_write_raw(const uint8_t *data, uint32_t len);
 
 bool ble_test(char *mod_name);
 void circular_buff_test(void);
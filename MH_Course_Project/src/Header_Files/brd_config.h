@@ -12,6 +12,7 @@
 #include "em_gpio.h"
 
 /* The developer's include statements */
+#include "brd_energy.h"
 
 
 //***********************************************************************************
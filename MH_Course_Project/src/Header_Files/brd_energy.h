@@ -0,0 +1,69 @@
+#ifndef BRD_ENERGY_HG
+#define BRD_ENERGY_HG
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+/* System include statements */
+
+
+/* Silicon Labs include statements */
+
+
+/* The developer's include statements */
+
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+
+// Energy model calibration of this board, kept free of any includes so the
+// host build of the energy model can use the same table. The MCU and Si7021
+// currents are typical datasheet figures at 3.3 V, and the parts with no
+// datasheet figure are left at 0. All of them should be replaced by bench
+// measurements of each board.
+
+// Current of the MCU in each energy mode in nA. EM0 is the part that does not
+// depend on the core clock, which the HFRCO band changes, and EM1 is at 32 MHz.
+// EM2 and EM3 are with all 256k of RAM retained, and the energy estimate takes
+// off BOARD_RAM_RETAIN_NA for the RAM the linker script lets main() power down
+#define BOARD_EM0_NA			0
+#define BOARD_EM1_NA			1100000
+#define BOARD_EM2_NA			2500
+#define BOARD_EM3_NA			2100
+#define BOARD_EM4_NA			900
+
+// EM2/EM3 current of retaining each 16k of RAM, in nA. From the datasheet EM2
+// figures with 256k and with 4k retained, 2.5 uA and 2.2 uA, over the 252k
+// between them
+#define BOARD_RAM_RETAIN_NA		19
+
+// Current of the MCU in EM0 per MHz of core clock, in nA
+#define BOARD_EM0_NA_PER_MHZ	65625
+
+// Current of the parts outside the MCU that is always drawn, such as the BLE module
+#define BOARD_BASE_NA			0
+
+// Current added while an I2C transaction is running, mostly the Si7021 conversion
+#define BOARD_I2C_NA			150000
+
+// Current added while the LEUART is sending a byte to the BLE module
+#define BOARD_LEUART_TX_NA		0
+
+// Time on the line of one LEUART byte, start, 8 data and stop bit at 9600 baud
+#define BOARD_LEUART_BYTE_US	1042
+
+// Supply voltage and battery capacity used to project the battery life
+#define BOARD_SUPPLY_MV			3300
+#define BOARD_BATTERY_MAH		225		// CR2032 coin cell
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+
+#endif
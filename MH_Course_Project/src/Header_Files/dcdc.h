@@ -0,0 +1,60 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	DCDC_HG
+#define	DCDC_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Silicon Labs include statements */
+#include "em_emu.h"
+#include "em_core.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "sw_timer.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+//#define DCDC_FIXED_ENABLED				// Keeps the DC-DC in low noise, for comparison
+
+#define	DCDC_HOLD_MS		50				// Time low noise is kept after the last vote is released
+
+// DC-DC levels in EM0/EM1 a client can vote for, the highest vote is used
+enum dcdc_level {
+	DCDC_LOW_POWER,			// discontinuous conduction, least loss at light load
+	DCDC_LOW_NOISE,			// continuous conduction, fixed frequency and least ripple
+	DCDC_LEVELS
+};
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct DCDC_CLIENT {
+	struct DCDC_CLIENT	*next;			// next client in registration order
+	const char			*name;			// shown in reports
+	uint32_t			level;			// level voted for, DCDC_LOW_POWER once released
+	uint32_t			votes;			// times the client has voted
+} DCDC_CLIENT;
+
+typedef struct {
+	uint32_t			changes;			// times the level has changed
+	uint32_t			ms[DCDC_LEVELS];	// time spent at each level, in ms
+} DCDC_STATS;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void dcdc_open(void);
+void dcdc_client_register(DCDC_CLIENT *client, const char *name);
+void dcdc_vote(DCDC_CLIENT *client, uint32_t level);
+void dcdc_release(DCDC_CLIENT *client);
+void dcdc_update(void);
+uint32_t dcdc_level(void);
+void dcdc_stats(DCDC_STATS *out);
+
+#endif
@@ -0,0 +1,52 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	ENERGY_HG
+#define	ENERGY_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Silicon Labs include statements */
+#include "em_device.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "energy_model.h"
+#include "sleep_routines.h"
+#include "sw_timer.h"
+#include "i2c.h"
+#include "leuart.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	ENERGY_RAM_BLOCK_BYTES	16384	// RAM the retention current of BOARD_RAM_RETAIN_NA is for
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct {
+	uint32_t			cycles;			// measurement cycles since energy_open()
+	uint32_t			last_nc;		// charge of the last cycle
+	uint32_t			mean_nc;		// average charge of a cycle
+	uint32_t			last_uj;		// energy of the last cycle
+	uint32_t			last_ms;		// length of the last cycle
+	uint32_t			last_kcycles;	// thousands of core cycles run in the last cycle
+	uint32_t			average_na;		// average current since energy_open()
+	uint32_t			life_hours;		// battery life at the average current
+	uint32_t			ram_kbytes;		// RAM retained in EM2/EM3
+	uint32_t			ram_saved_na;	// EM2/EM3 current saved by powering down the rest
+} ENERGY_REPORT;
+
+extern char __ram_retained_end;	// End of the RAM the linker script places anything in
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void energy_open(void);
+void energy_cycle(void);
+void energy_report(ENERGY_REPORT *report);
+
+#endif
@@ -0,0 +1,62 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	ENERGY_MODEL_HG
+#define	ENERGY_MODEL_HG
+
+/* System include statements */
+#include <stdint.h>
+
+/* Silicon Labs include statements */
+
+/* The developer's include statements */
+#include "brd_energy.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	ENERGY_MODES			5		// EM0 to EM4, the same as MAX_ENERGY_MODES
+
+// Calibration of this board from brd_energy.h
+#define	ENERGY_CAL_BOARD	{													\
+	.mode_na = {BOARD_EM0_NA, BOARD_EM1_NA, BOARD_EM2_NA, BOARD_EM3_NA, BOARD_EM4_NA},	\
+	.em0_na_per_mhz = BOARD_EM0_NA_PER_MHZ,										\
+	.base_na = BOARD_BASE_NA,													\
+	.i2c_na = BOARD_I2C_NA,														\
+	.leuart_tx_na = BOARD_LEUART_TX_NA,											\
+	.leuart_byte_us = BOARD_LEUART_BYTE_US,										\
+	.supply_mv = BOARD_SUPPLY_MV,												\
+	.battery_mah = BOARD_BATTERY_MAH,											\
+}
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct {
+	uint32_t			mode_na[ENERGY_MODES];	// MCU current in each energy mode
+	uint32_t			em0_na_per_mhz;			// MCU current in EM0 per MHz of core clock
+	uint32_t			base_na;				// current drawn all the time outside the MCU
+	uint32_t			i2c_na;					// current added during an I2C transaction
+	uint32_t			leuart_tx_na;			// current added while a byte is sent
+	uint32_t			leuart_byte_us;			// time on the line of one byte
+	uint32_t			supply_mv;				// supply voltage
+	uint32_t			battery_mah;			// battery capacity
+} ENERGY_CALIBRATION;
+
+typedef struct {
+	uint32_t			mode_ms[ENERGY_MODES];	// time spent in each energy mode
+	uint32_t			i2c_ms;					// time spent in I2C transactions
+	uint32_t			leuart_bytes;			// bytes sent over the LEUART
+	uint32_t			core_kcycles;			// thousands of core clock cycles run in EM0
+} ENERGY_SAMPLE;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+uint64_t energy_model_charge_pc(const ENERGY_CALIBRATION *cal, const ENERGY_SAMPLE *sample);
+uint32_t energy_model_sample_ms(const ENERGY_SAMPLE *sample);
+uint32_t energy_model_uj(const ENERGY_CALIBRATION *cal, uint64_t charge_pc);
+uint32_t energy_model_average_na(uint64_t charge_pc, uint32_t ms);
+uint32_t energy_model_life_hours(const ENERGY_CALIBRATION *cal, uint32_t average_na);
+
+#endif
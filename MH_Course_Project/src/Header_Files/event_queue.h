@@ -0,0 +1,51 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	EVENT_QUEUE_HG
+#define	EVENT_QUEUE_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Silicon Labs include statements */
+#include "em_device.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "scheduler.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	EVENT_QUEUE_SIZE		16		// Must be a power of two
+#define	EVENT_QUEUE_MASK		(EVENT_QUEUE_SIZE - 1)
+
+//#define EVENT_QUEUE_TEST_ENABLED
+#define	EVENT_QUEUE_TEST_ROUNDS	8
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct {
+	uint32_t				event;			// scheduler event the entry belongs to
+	uint32_t				payload;		// data carried with the event
+} EVENT_QUEUE_ENTRY;
+
+typedef struct {
+	EVENT_QUEUE_ENTRY		entry[EVENT_QUEUE_SIZE];
+	volatile uint32_t		write_ptr;		// only written by the producer (ISR)
+	volatile uint32_t		read_ptr;		// only written by the consumer (main loop)
+	volatile uint32_t		overflow;		// posts dropped because the queue was full
+} EVENT_QUEUE;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void event_queue_open(EVENT_QUEUE *queue);
+bool event_queue_post(EVENT_QUEUE *queue, uint32_t event, uint32_t payload);
+bool event_queue_get(EVENT_QUEUE *queue, uint32_t event, uint32_t *payload);
+void event_queue_notify(EVENT_QUEUE *queue);
+uint32_t event_queue_count(EVENT_QUEUE *queue);
+
+#endif
@@ -0,0 +1,56 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	HIBERNATE_HG
+#define	HIBERNATE_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Silicon Labs include statements */
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_rmu.h"
+#include "em_rtcc.h"
+#include "em_cryotimer.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	HIBERNATE_PERIOD		cryotimerPeriod_64k	// ULFRCO cycles between wakeups
+#define	HIBERNATE_PERIOD_TICKS	65536				// HIBERNATE_PERIOD in ms on the 1 kHz ULFRCO
+#define	HIBERNATE_MAGIC			0x4849424Eu			// Marks the retention registers as valid
+#define	HIBERNATE_FLAG_CELSIUS	0x01				// Readings are sent in Celsius
+
+// Retention registers of the RTCC used to hold the state through EM4H
+enum hibernate_ret {
+	HIBERNATE_RET_MAGIC,
+	HIBERNATE_RET_FLAGS,
+	HIBERNATE_RET_WAKES,
+	HIBERNATE_RET_AWAKE,
+};
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct {
+	uint32_t			flags;			// HIBERNATE_FLAG_ application settings
+	uint32_t			wakes;			// wakeups since hibernation started
+	uint32_t			awake_ms;		// time the previous wakeup spent awake
+} HIBERNATE_STATE;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+bool hibernate_woke(void);
+void hibernate_load(HIBERNATE_STATE *state);
+uint32_t hibernate_ms_since_wake(void);
+void hibernate_clear(void);
+void hibernate_enter(HIBERNATE_STATE *state);
+
+#endif
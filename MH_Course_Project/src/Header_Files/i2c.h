@@ -16,6 +16,9 @@
 /* The developer's include statements */
 #include "scheduler.h"
 #include "sleep_routines.h"
+#include "event_queue.h"
+#include "sw_timer.h"
+#include "perf.h"
 
 //***********************************************************************************
 // defined variables
@@ -49,11 +52,13 @@ typedef struct{
 	uint32_t				*data;
 //	uint32_t				byte_cnt;
 	bool					read;
+	bool					busy;
 	I2C_TypeDef *			I2Cn;
 	uint32_t				callback;
 } I2C_STATE_MACHINE;
 
 #define	I2C_EM_BLOCK 	2
+#define	I2C_MAX_HOLD_MS	100		// Longest a transaction should keep I2C_EM_BLOCK blocked
 
 //***********************************************************************************
 // function prototypes
@@ -61,5 +66,8 @@ typedef struct{
 void i2c_open(I2C_TypeDef *i2c, I2C_OPEN_STRUCT *i2c_setup);
 void I2C0_IRQHandler(void);
 void i2c_start(uint32_t slave_add, uint32_t cmd,  uint32_t *read_data, I2C_TypeDef * i2c, uint32_t si7021_read_cb);
+bool i2c_busy(void);
+uint32_t i2c_active_ms(void);
+EVENT_QUEUE *i2c_event_queue(void);
 
 #endif
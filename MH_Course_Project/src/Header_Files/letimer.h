@@ -16,12 +16,14 @@
 /* The developer's include statements */
 #include "scheduler.h"
 #include "sleep_routines.h"
+#include "event_queue.h"
 
 //***********************************************************************************
 // defined files
 //***********************************************************************************
 #define LETIMER_HZ		1000			// Utilizing ULFRCO oscillator for LETIMERs
 #define	LETIMER_EM		EM4				// Using the ULFRCO, block from entering EM4
+#define	LETIMER_IDLE	0xFFFFFFFF		// No underflow coming, the LETIMER is stopped
 //***********************************************************************************
 // global variables
 //***********************************************************************************
@@ -49,5 +51,8 @@ typedef struct {
 void letimer_pwm_open(LETIMER_TypeDef *letimer, APP_LETIMER_PWM_TypeDef *app_letimer_struct);
 void letimer_start(LETIMER_TypeDef *letimer, bool enable);
 void LETIMER0_IRQHandler(void);
+EVENT_QUEUE *letimer_event_queue(void);
+uint32_t letimer_ms_to_underflow(LETIMER_TypeDef *letimer);
+void letimer_event_queue_test(void);
 
 #endif
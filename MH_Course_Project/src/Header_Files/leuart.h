@@ -6,7 +6,9 @@
 
 #include "em_leuart.h"
 #include "sleep_routines.h"
+#include "event_queue.h"
 #include "HW_delay.h"
+#include "dcdc.h"
 
 
 //***********************************************************************************
@@ -15,6 +17,7 @@
 
 #define LEUART_TX_EM		EM3
 #define LEUART_RX_EM		EM3
+#define LEUART_TX_MAX_HOLD_MS	250	// Longest a transmit should keep LEUART_TX_EM blocked
 
 /***************************************************************************//**
  * @addtogroup leuart
@@ -82,7 +85,9 @@ enum rx_leuart_defined_states {
 void leuart_open(LEUART_TypeDef *leuart, LEUART_OPEN_STRUCT *leuart_settings);
 void LEUART0_IRQHandler(void);
 void leuart_start(LEUART_TypeDef *leuart, char *string);
+void leuart_start_len(LEUART_TypeDef *leuart, const char *data, uint32_t len);
 bool leuart_busy(void);
+uint32_t leuart_tx_bytes(void);
 
 uint32_t leuart_status(LEUART_TypeDef *leuart);
 void leuart_cmd_write(LEUART_TypeDef *leuart, uint32_t cmd_update);
@@ -91,4 +96,5 @@ void leuart_app_transmit_byte(LEUART_TypeDef *leuart, uint8_t data_out);
 uint8_t leuart_app_receive_byte(LEUART_TypeDef *leuart);
 void leuart_rx_test(void);
 char* rx_str(void);
+EVENT_QUEUE *leuart_event_queue(void);
 #endif
@@ -0,0 +1,60 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	PERF_HG
+#define	PERF_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Silicon Labs include statements */
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_core.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "brd_config.h"
+#include "trace.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+//#define PERF_FIXED_ENABLED				// Keeps the core at MCU_HFXO_FREQ, for comparison
+
+#define	PERF_MAX_HZ		((uint32_t)MCU_HFXO_FREQ)	// Fastest band a client can get
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct PERF_CLIENT {
+	struct PERF_CLIENT	*next;			// next client in registration order
+	const char			*name;			// shown in reports
+	uint32_t			min_hz;			// core frequency requested, 0 once released
+	uint32_t			requests;		// times the client has made a request
+} PERF_CLIENT;
+
+// Called with the new core frequency each time the HFRCO band changes
+typedef void (*PERF_NOTIFY_FN)(uint32_t core_hz);
+
+typedef struct PERF_NOTIFY {
+	struct PERF_NOTIFY	*next;			// next listener in registration order
+	PERF_NOTIFY_FN		fn;
+} PERF_NOTIFY;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void perf_open(void);
+void perf_client_register(PERF_CLIENT *client, const char *name);
+void perf_notify_register(PERF_NOTIFY *notify, PERF_NOTIFY_FN fn);
+void perf_request(PERF_CLIENT *client, uint32_t min_hz);
+void perf_release(PERF_CLIENT *client);
+void perf_apply(void);
+void perf_update(void);
+uint32_t perf_core_hz(void);
+uint32_t perf_changes(void);
+
+#endif
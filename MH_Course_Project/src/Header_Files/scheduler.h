@@ -6,10 +6,12 @@
 
 /* System include statements */
 #include <stdint.h>
+#include <stdbool.h>
 
 /* Silicon Labs include statements */
 #include "em_assert.h"
 #include "em_int.h"
+#include "em_cmu.h"
 
 /* The developer's include statements */
 //#include "sleep_routines.h"
@@ -17,20 +19,80 @@
 //***********************************************************************************
 // defined files
 //***********************************************************************************
+// Dispatch priorities, the highest pending priority is always serviced first
+#define	SCHEDULER_PRIORITY_LEVELS	4
+#define	SCHEDULER_PRIORITY_LOW		0
+#define	SCHEDULER_PRIORITY_NORMAL	1
+#define	SCHEDULER_PRIORITY_HIGH		2
+#define	SCHEDULER_PRIORITY_URGENT	3
 
+// One word of pending events for each priority level, one event per bit
+#define	SCHEDULER_WORD_BITS		32
+#define	SCHEDULER_MAX_EVENTS	(SCHEDULER_PRIORITY_LEVELS * SCHEDULER_WORD_BITS)
+#define	SCHEDULER_NO_EVENT		0		// Never returned as an event handle
+#define	SCHEDULER_MAX_REGISTERED	16		// Events with a handler, counters and histogram
+
+// Handler run time budget and starvation detection
+#define	SCHEDULER_BUDGET_DEFAULT	1000		// us, the same at every HFRCO band
+#define	SCHEDULER_BUDGET_NONE		0xFFFFFFFF	// Handler is never flagged for its run time
+#define	SCHEDULER_STARVE_ROUNDS		8			// Dispatches an event may wait through
+
+// Latency histograms, bucket n counts latencies of 2^(n-1) to 2^n - 1 us
+#define	SCHEDULER_HIST_BUCKETS		24		// The last bucket also counts everything longer
+#define	SCHEDULER_HIST_MAX			0xFFFF	// Bucket counts stop at the largest uint16_t
+
+//#define SCHEDULER_BENCH_ENABLED
+#define	SCHEDULER_BENCH_ROUNDS		64		// Post and remove pairs timed by the atomic benchmark
 
 //***********************************************************************************
 // global variables
 //***********************************************************************************
+typedef void (*SCHEDULER_CB)(void);
+typedef void (*SCHEDULER_HOOK)(uint32_t event);
+
+typedef struct {
+	uint32_t				chain_cycles;		// if-chain cost with one event pending
+	uint32_t				dispatch_cycles;	// count-leading-zeros lookup cost with one event pending
+} SCHEDULER_BENCH_RESULT;
+
+typedef struct {
+	uint32_t				critical_cycles;	// post and remove cost with a critical section
+	uint32_t				critical_masked;	// cycles of that with interrupts masked
+	uint32_t				atomic_cycles;		// post and remove cost with exclusive access
+} SCHEDULER_ATOMIC_BENCH_RESULT;
+
+typedef struct {
+	uint32_t				posts;				// calls to add_scheduled_event()
+	uint32_t				coalesced;			// posts made while the event was already pending
+	uint32_t				dispatches;			// calls to the event handler
+	uint32_t				max_pending;		// longest post to dispatch time in us
+	uint32_t				max_run;			// longest handler run time in us
+	uint32_t				overruns;			// handler runs longer than the budget
+	uint32_t				max_rounds;			// most other dispatches while pending
+	uint32_t				starved;			// dispatches after more than SCHEDULER_STARVE_ROUNDS
+} SCHEDULER_EVENT_STATS;
 
 
 //***********************************************************************************
 // function prototypes
 //***********************************************************************************
 void scheduler_open(void);
+void scheduler_clock_set(uint32_t core_hz);
 void add_scheduled_event(uint32_t event);
 void remove_scheduled_event(uint32_t event);
 uint32_t get_scheduled_events(void);
+uint32_t scheduler_register_event(SCHEDULER_CB cb, uint32_t priority);
+void scheduler_dispatch(void);
+void scheduler_dispatch_bench(void);
+void scheduler_atomic_bench(void);
+uint32_t scheduler_worst_latency(uint32_t priority);
+void scheduler_latency_reset(void);
+bool scheduler_get_stats(uint32_t event, SCHEDULER_EVENT_STATS *stats);
+void scheduler_stats_reset(void);
+void scheduler_set_dispatch_hook(SCHEDULER_HOOK hook);
+bool scheduler_get_histogram(uint32_t event, uint16_t *hist);
+void scheduler_set_budget(uint32_t event, uint32_t us);
+uint32_t scheduler_violations(void);
 
 
 #endif
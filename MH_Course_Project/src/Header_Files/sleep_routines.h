@@ -8,6 +8,8 @@
 #ifndef SRC_HEADER_FILES_SLEEP_ROUTINES_H_
 #define SRC_HEADER_FILES_SLEEP_ROUTINES_H_
 
+#include "em_device.h"
+#include "em_cmu.h"
 #include "em_emu.h"
 #include "em_int.h"
 #include "em_core.h"
@@ -20,11 +22,90 @@
 #define		EM4				4
 #define	MAX_ENERGY_MODES	5
 
+#define	SLEEP_IDLE_UNKNOWN	0xFFFFFFFF	// No deadline is known, sleep as deep as allowed
+#define	SLEEP_COST_FACTOR	10			// Idle time must be this many wakeup times to enter a mode
+#define	SLEEP_AVG_SHIFT		3			// Moving averages weigh each new sample by 1/8
+#define	SLEEP_MAX_BLOCKS	5			// Blocks of one mode allowed at a time
+
+// Blocked mode bitmask, EM0 is the top bit so __CLZ() gives the shallowest blocked mode
+#define	SLEEP_BLOCK_BIT(EM)	(1u << (31 - (EM)))
+
+#define	SLEEP_HOLD_UNLIMITED	0		// Owner is expected to hold its blocks indefinitely
+
+#define	SLEEP_MAX_HOOKS			8		// Suspend/resume hooks that can be registered
+
+// Order of the suspend hooks, resumed in the reverse order
+enum sleep_hook_order {
+	SLEEP_HOOK_SENSOR,		// Si7021 is powered down while its bus is still routed
+	SLEEP_HOOK_I2C,
+	SLEEP_HOOK_LEUART,
+};
+
+//#define SLEEP_ARBITER_TEST_ENABLED
+#define	SLEEP_ARBITER_TEST_STEPS	2000
+
+typedef struct {
+	uint32_t	decisions;		// times the mode was entered
+	uint32_t	demoted;		// times the mode was entered because a deeper mode was not worth it
+	uint32_t	predicted;		// times the idle time came from the moving average, not a deadline
+} SLEEP_DECISION_STATS;
+
+typedef struct {
+	uint32_t	entry_cycles;	// average core cycles from choosing the mode to sleeping
+	uint32_t	exit_cycles;	// average core cycles from waking up to returning
+	uint32_t	break_even_us;	// shortest predicted idle time the mode is entered for
+} SLEEP_LATENCY;
+
+typedef struct {
+	uint32_t	entries;		// times the mode was entered, wakeups for EM0
+	uint32_t	ticks;			// time spent in the mode, in software timer ticks
+} SLEEP_RESIDENCY;
+
+typedef struct SLEEP_OWNER {
+	struct SLEEP_OWNER	*next;						// next owner in registration order
+	const char			*name;						// name used in the leak report
+	uint32_t			max_hold_ms;				// longest expected hold, or SLEEP_HOLD_UNLIMITED
+	uint32_t			blocks[MAX_ENERGY_MODES];	// blocks currently held on each mode
+	uint32_t			held;						// blocks currently held on all modes
+	uint32_t			total;						// blocks made since registering
+	uint32_t			last_block;					// software timer tick of the latest block
+	uint32_t			held_since;					// software timer tick the owner started holding
+} SLEEP_OWNER;
+
+// Suspends or resumes a peripheral around a sleep in the given energy mode
+typedef void (*SLEEP_HOOK_FN)(uint32_t EM);
+
+typedef struct {
+	SLEEP_HOOK_FN		suspend;		// called before the core sleeps
+	SLEEP_HOOK_FN		resume;			// called once the core has woken up
+	uint32_t			min_mode;		// shallowest energy mode the hook runs for
+	uint32_t			order;			// sleep_hook_order, lower is suspended first
+	uint32_t			runs;			// sleeps the hook has run for
+} SLEEP_HOOK;
+
 void sleep_open(void);
-void sleep_block_mode(uint32_t EM);
-void sleep_unblock_mode(uint32_t EM);
+void sleep_clock_set(uint32_t core_hz);
+void sleep_owner_register(SLEEP_OWNER *owner, const char *name, uint32_t max_hold_ms);
+void sleep_block_mode(SLEEP_OWNER *owner, uint32_t EM);
+void sleep_unblock_mode(SLEEP_OWNER *owner, uint32_t EM);
+void sleep_hook_register(SLEEP_HOOK *hook, SLEEP_HOOK_FN suspend, SLEEP_HOOK_FN resume,
+		uint32_t min_mode, uint32_t order);
+const SLEEP_OWNER *sleep_owner_get(uint32_t index);
+uint32_t sleep_owner_held_ms(const SLEEP_OWNER *owner);
+bool sleep_owner_leaking(const SLEEP_OWNER *owner);
+uint32_t sleep_owner_leaks(void);
 void enter_sleep(void);
+void enter_sleep_tickless(uint32_t idle_ms);
 uint32_t current_block_energy_mode(void);
+uint32_t sleep_deepest_allowed(void);
+void sleep_decision_stats(uint32_t EM, SLEEP_DECISION_STATS *stats);
+void sleep_decision_reset(void);
+void sleep_latency(uint32_t EM, SLEEP_LATENCY *lat);
+uint32_t sleep_idle_average_us(void);
+void sleep_residency(uint32_t EM, SLEEP_RESIDENCY *res);
+uint32_t sleep_residency_elapsed(void);
+void sleep_residency_reset(void);
+void sleep_arbiter_test(void);
 
 #endif /* SRC_HEADER_FILES_SLEEP_ROUTINES_H_ */
 
@@ -0,0 +1,54 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	SW_TIMER_HG
+#define	SW_TIMER_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Silicon Labs include statements */
+#include "em_rtcc.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "scheduler.h"
+#include "sleep_routines.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	SW_TIMER_HZ			1000			// RTCC clocked from the ULFRCO, one tick per ms
+#define	SW_TIMER_EM			EM4				// Using the ULFRCO, block from entering EM4
+#define	SW_TIMER_CC			1				// RTCC compare channel shared by all timers
+
+//#define SW_TIMER_TEST_ENABLED
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct SW_TIMER {
+	struct SW_TIMER		*next;			// next timer in deadline order
+	uint32_t			deadline;		// RTCC tick the timer expires on
+	uint32_t			period;			// ticks between expirations, 0 for one-shot
+	uint32_t			event;			// scheduler event posted on expiration, SCHEDULER_NO_EVENT for none
+	uint32_t			count;			// number of times the timer has expired
+	bool				active;			// timer is in the deadline list
+} SW_TIMER;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void sw_timer_open(void);
+void sw_timer_start(SW_TIMER *timer, uint32_t event, uint32_t delay_ms, uint32_t period_ms);
+void sw_timer_stop(SW_TIMER *timer);
+uint32_t sw_timer_now(void);
+bool sw_timer_next_deadline(uint32_t *deadline);
+void RTCC_IRQHandler(void);
+void sw_timer_test(void);
+
+#endif
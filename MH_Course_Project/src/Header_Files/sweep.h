@@ -0,0 +1,44 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	SWEEP_HG
+#define	SWEEP_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Silicon Labs include statements */
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "sleep_routines.h"
+#include "perf.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+//#define SWEEP_BENCH_ENABLED
+#define	SWEEP_DWELL_MS		60000		// Time spent at each energy mode
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct {
+	uint32_t	readings;						// readings completed during the dwell
+	uint32_t	missed;							// readings expected but not completed
+	uint32_t	wake_us;						// measured exit latency of the mode
+	uint32_t	percent[MAX_ENERGY_MODES];		// residency of each mode during the dwell
+} SWEEP_RESULT;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void sweep_open(uint32_t levels, uint32_t period_ms);
+uint32_t sweep_levels(void);
+void sweep_begin(uint32_t EM);
+void sweep_reading(void);
+void sweep_end(void);
+void sweep_result(uint32_t EM, SWEEP_RESULT *result);
+
+#endif
@@ -0,0 +1,96 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	TASK_HG
+#define	TASK_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Silicon Labs include statements */
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "scheduler.h"
+#include "sw_timer.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+
+/*
+ * Stackless coroutine macros. The body of a task function is placed between
+ * TASK_BEGIN and TASK_END, and each wait saves the line it is on so the next
+ * call of the function jumps straight back to it. Local variables are not kept
+ * across a wait, so any state that must survive a wait belongs in a static or
+ * in the TASK struct. Only one wait may be placed on a line, and a task may not
+ * wait from inside a switch statement of its own.
+ */
+#define	TASK_BEGIN(task)				switch((task)->line){ case 0:
+
+#define	TASK_END(task)					} (task)->line = 0; return true;
+
+// Returns to the scheduler until cond is true, checked every time the task runs
+#define	TASK_WAIT_UNTIL(task, cond)		do {								\
+											(task)->line = __LINE__;		\
+											case __LINE__:					\
+											if(!(cond)) return false;		\
+										} while(0)
+
+// Returns to the scheduler and runs again once the other pending events are serviced
+#define	TASK_YIELD(task)				do {								\
+											(task)->line = __LINE__;		\
+											task_signal(task);				\
+											return false;					\
+											case __LINE__:;					\
+										} while(0)
+
+// Sleeps for ms milliseconds on the software timer of the task
+#define	TASK_DELAY(task, ms)			do {								\
+											sw_timer_start(&(task)->timer, (task)->event, (ms), 0);	\
+											TASK_WAIT_UNTIL(task, !(task)->timer.active);			\
+										} while(0)
+
+// Waits for a scheduler event to be dispatched for at most ms milliseconds
+#define	TASK_WAIT_EVENT(task, ev, ms)	do {								\
+											(task)->wait_event = (ev);		\
+											(task)->event_seen = false;		\
+											sw_timer_start(&(task)->timer, (task)->event, (ms), 0);	\
+											TASK_WAIT_UNTIL(task, (task)->event_seen || !(task)->timer.active);	\
+											sw_timer_stop(&(task)->timer);	\
+											(task)->wait_event = SCHEDULER_NO_EVENT;	\
+											(task)->timed_out = !(task)->event_seen;	\
+										} while(0)
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct TASK TASK;
+
+// Runs the task up to its next wait, returns true once the task has finished
+typedef bool (*TASK_FN)(TASK *task);
+
+struct TASK {
+	TASK				*next;			// next task in the list of created tasks
+	TASK_FN				fn;				// body of the task
+	uint32_t			event;			// scheduler event whose handler calls task_run()
+	uint32_t			line;			// line to resume from, 0 to start from the beginning
+	uint32_t			wait_event;		// scheduler event being waited on, SCHEDULER_NO_EVENT for none
+	bool				event_seen;		// wait_event was dispatched during the wait
+	bool				timed_out;		// the last TASK_WAIT_EVENT ran out of time
+	bool				running;		// task has been started and has not finished
+	SW_TIMER			timer;			// timer used for delays and timeouts
+};
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void task_open(void);
+void task_create(TASK *task, TASK_FN fn, uint32_t event);
+void task_start(TASK *task);
+void task_run(TASK *task);
+void task_signal(TASK *task);
+
+#endif
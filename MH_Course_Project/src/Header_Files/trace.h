@@ -0,0 +1,66 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	TRACE_HG
+#define	TRACE_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Silicon Labs include statements */
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "atomic.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	TRACE_RECORDS			128			// Must be a power of two, 8 bytes each
+#define	TRACE_MASK				(TRACE_RECORDS - 1)
+
+// Binary dump packets, each starts with TRACE_SYNC and a record count
+#define	TRACE_SYNC				0xA5		// Never sent in the ASCII strings of the BLE link
+#define	TRACE_VERSION			1
+#define	TRACE_PACKET_HEADER		2			// Sync byte and record count
+#define	TRACE_INFO_SIZE			10			// First packet, header, version, count and clock
+#define	TRACE_PACKET_RECORDS	7			// Records per packet, fits the LEUART buffer
+#define	TRACE_PACKET_SIZE		(TRACE_PACKET_HEADER + TRACE_PACKET_RECORDS * 8)
+
+// Record IDs, the meaning of the argument is given for each
+enum trace_ids {
+	TRACE_POST = 1,			// scheduler event handle posted
+	TRACE_DISPATCH,			// scheduler event handle whose handler is called
+	TRACE_SLEEP,			// energy mode entered
+	TRACE_WAKE,				// milliseconds slept, the cycle counter stops while asleep
+	TRACE_I2C_START,		// I2C slave address
+	TRACE_I2C_STATE,		// I2C state after each interrupt
+	TRACE_LEUART_TX,		// bytes started on the LEUART
+	TRACE_LEUART_TX_DONE,	// bytes sent on the LEUART
+	TRACE_LEUART_RX,		// length of a received command
+	TRACE_WDOG_FEED,		// watchdog client whose check in fed the watchdog
+	TRACE_PERF				// new core frequency in kHz, the cycle counter rate changes
+};
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+typedef struct {
+	uint32_t				cycles;			// DWT cycle counter when recorded
+	uint16_t				id;				// one of enum trace_ids
+	uint16_t				arg;			// argument of the record
+} TRACE_RECORD;
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void trace_open(void);
+void trace_record(uint16_t id, uint16_t arg);
+void trace_freeze(void);
+void trace_resume(void);
+uint32_t trace_dump_packet(uint32_t *pos, uint8_t *packet);
+
+#endif
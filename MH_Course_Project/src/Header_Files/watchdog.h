@@ -0,0 +1,43 @@
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#ifndef	WATCHDOG_HG
+#define	WATCHDOG_HG
+
+/* System include statements */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Silicon Labs include statements */
+#include "em_wdog.h"
+#include "em_rmu.h"
+#include "em_assert.h"
+
+/* The developer's include statements */
+#include "atomic.h"
+#include "sw_timer.h"
+#include "trace.h"
+
+//***********************************************************************************
+// defined files
+//***********************************************************************************
+#define	WATCHDOG_PERIOD			wdogPeriod_8k	// 8193 ULFRCO cycles before a reset
+#define	WATCHDOG_TIMEOUT_MS		8193			// WATCHDOG_PERIOD in ms on the 1 kHz ULFRCO
+#define	WATCHDOG_MAX_CLIENTS	32				// One bit of the check in word each
+
+//***********************************************************************************
+// global variables
+//***********************************************************************************
+
+//***********************************************************************************
+// function prototypes
+//***********************************************************************************
+void watchdog_open(void);
+uint32_t watchdog_register(uint32_t period_ms);
+void watchdog_start(void);
+void watchdog_stop(void);
+void watchdog_checkin(uint32_t client);
+uint32_t watchdog_late(uint32_t client);
+bool watchdog_caused_reset(void);
+
+#endif
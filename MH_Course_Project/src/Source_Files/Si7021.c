@@ -16,6 +16,35 @@
 // Private functions
 //***********************************************************************************
 static uint32_t	data;
+static SLEEP_HOOK si7021_sleep_hook;
+static SLEEP_OWNER si7021_sleep_owner;
+static SW_TIMER powerup_timer;
+static uint32_t power_event;
+static uint32_t read_event;
+static bool powered;
+static bool powering_up;
+
+static void si7021_suspend(uint32_t EM);
+
+/***************************************************************************//**
+ * @brief
+ *	Powers down the Si7021 before the core sleeps in EM3.
+ *
+ * @details
+ *	The sensor enable pin also powers the I2C pull-ups, so both stop drawing
+ *	current. I2C_EM_BLOCK keeps the core out of EM3 while a reading is in
+ *	progress, and EM3 is blocked while the sensor powers up, so the sensor is
+ *	always idle here. There is no resume hook, the sensor stays off until
+ *	si7021_i2c_read() needs it.
+ *
+ * @param[in] EM
+ *   The energy mode being entered.
+ *
+ ******************************************************************************/
+static void si7021_suspend(uint32_t EM){
+	GPIO_PinOutClear(SI7021_SENSOR_EN_PORT, SI7021_SENSOR_EN_PIN);
+	powered = false;
+}
 //***********************************************************************************
 // Global functions
 //***********************************************************************************
@@ -28,15 +57,20 @@ static uint32_t	data;
  * @details
  * 	This function calls the i2c_open() function, and uses the definitions in si7021.h
  * 	to ensure that the I2C peripheral is configured to correctly read a value from the
- * 	si7021.
+ * 	si7021. The sensor is powered down during EM3 sleeps, and gpio_open() must
+ * 	already have powered it up.
  *
  * @param[in] si7021_read_cb
  *	The scheduler event value, which is required to clear the scheduler when
  * 	the I2C state machine has terminated.
  *
+ * @param[in] si7021_power_cb
+ *	The scheduler event posted once the sensor has had SI7021_POWERUP_MS to
+ *	power up, whose handler must call si7021_powered().
+ *
  ******************************************************************************/
 
-void si7021_i2c_open(uint32_t si7021_read_cb) {
+void si7021_i2c_open(uint32_t si7021_read_cb, uint32_t si7021_power_cb) {
 	I2C_OPEN_STRUCT i2c_si7021_struct;
 	i2c_si7021_struct.enable = true;
 	i2c_si7021_struct.master = true;
@@ -49,6 +83,12 @@ void si7021_i2c_open(uint32_t si7021_read_cb) {
 	i2c_si7021_struct.sda_loc = I2C_SDA_LOC;
 	i2c_si7021_struct.event_def = si7021_read_cb;
 	i2c_open(I2Cn, &i2c_si7021_struct);
+	power_event = si7021_power_cb;
+	powered = true;
+	powering_up = false;
+	powerup_timer.active = false;
+	sleep_owner_register(&si7021_sleep_owner, "si7021", SI7021_MAX_HOLD_MS);
+	sleep_hook_register(&si7021_sleep_hook, si7021_suspend, NULL, EM3, SLEEP_HOOK_SENSOR);
 }
 
 /***************************************************************************//**
@@ -58,7 +98,11 @@ void si7021_i2c_open(uint32_t si7021_read_cb) {
  * @details
  * 	This function calls the i2c_start() function, and uses the definitions in si7021.h
  * 	to ensure that the I2C peripheral is configured to correctly read a value from the
- * 	si7021.
+ * 	si7021. If the sensor was powered down for an EM3 sleep, it is powered up
+ * 	here and the read is started by si7021_powered() once the software timer
+ * 	has waited out SI7021_POWERUP_MS. EM3 is blocked during the wait, so the
+ * 	core sleeps in EM2 and the sensor is not powered down again. A read made
+ * 	while another is waiting for the sensor is dropped.
  *
  * @param[in] si7021_read_cb
  *	The scheduler event value, which is required to clear the scheduler when
@@ -66,9 +110,51 @@ void si7021_i2c_open(uint32_t si7021_read_cb) {
  *
  ******************************************************************************/
 void si7021_i2c_read(uint32_t si7021_read_cb){
+	if(powering_up){
+		return;
+	}
+	if(!powered){
+		GPIO_PinOutSet(SI7021_SENSOR_EN_PORT, SI7021_SENSOR_EN_PIN);
+		powered = true;
+		powering_up = true;
+		read_event = si7021_read_cb;
+		sleep_block_mode(&si7021_sleep_owner, EM3);
+		sw_timer_start(&powerup_timer, power_event, SI7021_POWERUP_MS, 0);
+		return;
+	}
 	i2c_start(slave_address, temp_noHold, &data, I2Cn, si7021_read_cb);
 }
 
+/***************************************************************************//**
+ * @brief
+ *	Starts the read that was waiting for the sensor to power up.
+ *
+ * @details
+ *	The I2C transaction blocks I2C_EM_BLOCK itself, so EM3 is only released
+ *	once it has started.
+ *
+ * @note
+ *	Called by the handler of the power up event given to si7021_i2c_open().
+ *
+ ******************************************************************************/
+void si7021_powered(void){
+	if(!powering_up){
+		return;
+	}
+	powering_up = false;
+	i2c_start(slave_address, temp_noHold, &data, I2Cn, read_event);
+	sleep_unblock_mode(&si7021_sleep_owner, EM3);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns whether a read is waiting for the sensor or running on the bus.
+ *
+ ******************************************************************************/
+bool si7021_busy(void){
+	return powering_up || i2c_busy();
+}
+
 /***************************************************************************//**
  * @brief
  *	This function converts the temperature data code from the si7021 to the temperature
@@ -80,6 +166,23 @@ void si7021_i2c_read(uint32_t si7021_read_cb){
  *
  ******************************************************************************/
 float si7021_temp(void){
-	float celsius = (175.72*data)/65536-46.85;
+	return si7021_temp_convert(data);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	This function converts a temperature code read from the si7021 to the
+ *	temperature in Fahrenheit.
+ *
+ * @details
+ * 	This function uses the equation found in the si7021 documentation, and is
+ * 	used with the code carried by the I2C completion event.
+ *
+ * @param[in] code
+ *	The 16-bit temperature code read from the si7021.
+ *
+ ******************************************************************************/
+float si7021_temp_convert(uint32_t code){
+	float celsius = (175.72*code)/65536-46.85;
 	return 32 + (9./5)*celsius;
 }
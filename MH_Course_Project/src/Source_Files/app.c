@@ -16,10 +16,68 @@
 //***********************************************************************************
 
 static void app_letimer_pwm_open(float period, float act_period, uint32_t out0_route, uint32_t out1_route);
+static void app_report_start(APP_REPORT gen);
+static void app_report_next(void);
+static void app_trace_start(void);
+static void app_trace_next(void);
+static bool app_report_stats(uint32_t *line, char *str);
+static bool app_report_sleep(uint32_t *line, char *str);
+static bool app_report_hist(uint32_t *line, char *str);
+static bool app_report_budget(uint32_t *line, char *str);
+static bool app_report_owners(uint32_t *line, char *str);
+static bool app_report_energy(uint32_t *line, char *str);
+static bool app_report_sweep(uint32_t *line, char *str);
+static bool app_boot_task(TASK *task);
+static bool app_sweep_task(TASK *task);
+static bool app_stats_job(BG_JOB *job);
+static void app_hibernate(void);
 static char str[64];
 static char c_str[] = "#TEMP C!";
 static char f_str[] = "#TEMP F!";
+static char stats_str[] = "#STATS!";
+static char sleep_str[] = "#SLEEP!";
+static char sleep_clear_str[] = "#SLEEPCLR!";
+static char hist_str[] = "#HIST!";
+static char budget_str[] = "#BUDGET!";
+static char trace_str[] = "#TRACE!";
+static char owners_str[] = "#OWNERS!";
+static char energy_str[] = "#ENERGY!";
+static char leak_str[] = "Sleep block leak, see #OWNERS!\n";
+static char hibernate_str[] = "#HIBERNATE!";
+static char hibernating_str[] = "Hibernating\n";
 static bool celsius = false;
+static APP_REPORT report_gen;
+static uint32_t report_line;
+static char report_str[CSIZE];
+static bool trace_dumping = false;
+static uint32_t trace_packet;
+static uint8_t trace_buf[TRACE_PACKET_SIZE];
+static TASK boot_task;
+static TASK sweep_task;
+static uint32_t sweep_level;
+static uint32_t letimer0_comp0_event;
+static uint32_t letimer0_comp1_event;
+static uint32_t letimer0_uf_event;
+static uint32_t si7021_read_event;
+static uint32_t si7021_power_event;
+static uint32_t boot_up_event;
+static uint32_t sweep_event;
+static uint32_t ble_tx_event;
+static uint32_t ble_rx_event;
+static uint32_t sample_wdog;
+static uint32_t ble_tx_wdog;
+static SLEEP_OWNER app_sleep_owner;
+static PERF_NOTIFY scheduler_perf_notify;
+static PERF_NOTIFY sleep_perf_notify;
+static PERF_NOTIFY background_perf_notify;
+static bool leak_reported;
+static HIBERNATE_STATE hib_state;
+static bool hibernating;
+static BG_JOB stats_job;
+static uint32_t stats_sum_posts;
+static uint32_t stats_sum_dispatches;
+static uint32_t stats_total_posts;
+static uint32_t stats_total_dispatches;
 //***********************************************************************************
 // Global functions
 //***********************************************************************************
@@ -43,12 +101,151 @@ void app_peripheral_setup(void){
 	cmu_open();
 	gpio_open();
 	scheduler_open();
+	trace_open();
+	perf_open();
+	perf_notify_register(&scheduler_perf_notify, scheduler_clock_set);
+	ble_tx_event = scheduler_register_event(scheduled_ble_tx_cb, SCHEDULER_PRIORITY_URGENT);
+	letimer0_uf_event = scheduler_register_event(scheduled_letimer0_uf_cb, SCHEDULER_PRIORITY_HIGH);
+	ble_rx_event = scheduler_register_event(scheduled_ble_rx_cb, SCHEDULER_PRIORITY_NORMAL);
+	letimer0_comp1_event = scheduler_register_event(scheduled_letimer0_comp1_cb, SCHEDULER_PRIORITY_NORMAL);
+	letimer0_comp0_event = scheduler_register_event(scheduled_letimer0_comp0_cb, SCHEDULER_PRIORITY_NORMAL);
+	boot_up_event = scheduler_register_event(scheduled_boot_up_cb, SCHEDULER_PRIORITY_LOW);
+	sweep_event = scheduler_register_event(scheduled_sweep_cb, SCHEDULER_PRIORITY_LOW);
+	si7021_read_event = scheduler_register_event(si7021_temp_done_evt, SCHEDULER_PRIORITY_LOW);
+	si7021_power_event = scheduler_register_event(scheduled_si7021_power_cb, SCHEDULER_PRIORITY_LOW);
+	scheduler_set_budget(boot_up_event, SCHEDULER_BUDGET_NONE);
 	sleep_open();
+	perf_notify_register(&sleep_perf_notify, sleep_clock_set);
+	sleep_owner_register(&app_sleep_owner, "app", SLEEP_HOLD_UNLIMITED);
+	leak_reported = false;
+	sw_timer_open();
+	dcdc_open();
+	sleep_residency_reset();
+	hibernate_clear();
+	hibernating = false;
+	watchdog_open();
+	sample_wdog = watchdog_register(APP_WDOG_PERIOD_MS);
+	ble_tx_wdog = watchdog_register(APP_WDOG_PERIOD_MS);
+	background_open();
+	perf_notify_register(&background_perf_notify, background_clock_set);
+	task_open();
+	task_create(&boot_task, app_boot_task, boot_up_event);
+	task_create(&sweep_task, app_sweep_task, sweep_event);
 	app_letimer_pwm_open(PWM_PER, PWM_ACT_PER, PWM_ROUTE_0, PWM_ROUTE_1);
-	si7021_i2c_open(SI7021_READ_CB);
-	ble_open(BLE_TX_CB, BLE_RX_CB);
-	add_scheduled_event(BOOT_UP_CB);
-	sleep_block_mode(SYSTEM_BLOCK_EM);
+	si7021_i2c_open(si7021_read_event, si7021_power_event);
+	ble_open(ble_tx_event, ble_rx_event);
+	energy_open();
+	task_start(&boot_task);
+	sleep_block_mode(&app_sleep_owner, SYSTEM_BLOCK_EM);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Reinitialises the peripherals after a wakeup from hibernation.
+ *
+ * @details
+ *	Only what is needed to take one Si7021 reading and send it over BLE is
+ *	opened. The boot task and its self tests, the LETIMER and the background
+ *	jobs are skipped, and the reading is started straight away instead of
+ *	waiting for a LETIMER underflow. The GPIO are unlatched once they have been
+ *	configured again, so the Si7021 has stayed powered through EM4H. The
+ *	watchdog is started in case the reading or the transmit never finishes.
+ *
+ * @note
+ *	Called by main() instead of app_peripheral_setup() when hibernate_woke()
+ *	returns true.
+ *
+ ******************************************************************************/
+void app_wake_setup(void){
+	cmu_open();
+	gpio_open();
+	EMU_UnlatchPinRetention();
+	scheduler_open();
+	trace_open();
+	perf_open();
+	perf_notify_register(&scheduler_perf_notify, scheduler_clock_set);
+	ble_tx_event = scheduler_register_event(scheduled_ble_tx_cb, SCHEDULER_PRIORITY_URGENT);
+	ble_rx_event = scheduler_register_event(scheduled_ble_rx_cb, SCHEDULER_PRIORITY_NORMAL);
+	si7021_read_event = scheduler_register_event(si7021_temp_done_evt, SCHEDULER_PRIORITY_LOW);
+	si7021_power_event = scheduler_register_event(scheduled_si7021_power_cb, SCHEDULER_PRIORITY_LOW);
+	sleep_open();
+	perf_notify_register(&sleep_perf_notify, sleep_clock_set);
+	sleep_owner_register(&app_sleep_owner, "app", SLEEP_HOLD_UNLIMITED);
+	leak_reported = false;
+	sw_timer_open();
+	dcdc_open();
+	sleep_residency_reset();
+	hibernate_load(&hib_state);
+	hib_state.wakes++;
+	celsius = hib_state.flags & HIBERNATE_FLAG_CELSIUS;
+	hibernating = true;
+	watchdog_open();
+	sample_wdog = watchdog_register(APP_WDOG_PERIOD_MS);
+	ble_tx_wdog = watchdog_register(APP_WDOG_PERIOD_MS);
+	background_open();
+	perf_notify_register(&background_perf_notify, background_clock_set);
+	si7021_i2c_open(si7021_read_event, si7021_power_event);
+	ble_open(ble_tx_event, ble_rx_event);
+	sleep_block_mode(&app_sleep_owner, SYSTEM_BLOCK_EM);
+	watchdog_start();
+	si7021_i2c_read(si7021_read_event);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Enters hibernation once nothing is left to send.
+ *
+ * @details
+ *	Both LEDs are turned off, since the GPIO are latched through EM4H, and the
+ *	watchdog is stopped so it cannot reset the device while it hibernates.
+ *
+ ******************************************************************************/
+static void app_hibernate(void){
+	GPIO_PinOutClear(LED0_PORT, LED0_PIN);
+	GPIO_PinOutClear(LED1_PORT, LED1_PIN);
+	watchdog_stop();
+	hibernate_enter(&hib_state);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the time until the next known deadline of the application.
+ *
+ * @details
+ *	The only sources of wakeups that are known ahead of time are the LETIMER0
+ *	underflow that starts each temperature reading and the software timers, so
+ *	the idle time is the earlier of the two. The main loop passes it to the
+ *	tickless idle to choose how deep to sleep.
+ *
+ * @note
+ *	Called by the main loop before each background slice, and again from within
+ *	the critical section before sleeping.
+ *
+ * @return
+ *	Milliseconds until the next deadline, or SLEEP_IDLE_UNKNOWN if none.
+ *
+ ******************************************************************************/
+uint32_t app_idle_ms(void){
+	uint32_t idle_ms;
+	uint32_t timer_ms;
+	uint32_t deadline;
+	uint32_t now;
+
+	idle_ms = letimer_ms_to_underflow(LETIMER0);
+	if(idle_ms == LETIMER_IDLE){
+		idle_ms = SLEEP_IDLE_UNKNOWN;
+	}
+	if(sw_timer_next_deadline(&deadline)){
+		now = sw_timer_now();
+		timer_ms = 0;
+		if((int32_t)(deadline - now) > 0){
+			timer_ms = (deadline - now) * 1000 / SW_TIMER_HZ;
+		}
+		if(timer_ms < idle_ms){
+			idle_ms = timer_ms;
+		}
+	}
+	return idle_ms;
 }
 
 /***************************************************************************//**
@@ -95,30 +292,480 @@ void app_letimer_pwm_open(float period, float act_period, uint32_t out0_route, u
 	letimer_pwm_struct.comp0_irq_enable = false;
 	letimer_pwm_struct.comp1_irq_enable = false;
 	letimer_pwm_struct.uf_irq_enable = true;
-	letimer_pwm_struct.comp0_cb = LETIMER0_COMP0_CB;
-	letimer_pwm_struct.comp1_cb = LETIMER0_COMP1_CB;
-	letimer_pwm_struct.uf_cb = LETIMER0_UF_CB;
+	letimer_pwm_struct.comp0_cb = letimer0_comp0_event;
+	letimer_pwm_struct.comp1_cb = letimer0_comp1_event;
+	letimer_pwm_struct.uf_cb = letimer0_uf_event;
 	letimer_pwm_open(LETIMER0, &letimer_pwm_struct);
 
 	// letimer_start will inform the LETIMER0 peripheral to begin counting.
 	letimer_start(LETIMER0, true);
 }
 
+/***************************************************************************//**
+ * @brief
+ *	Starts sending a multi-line report over BLE.
+ *
+ * @details
+ *	The BLE circular buffer is too small to hold a whole report, so the report
+ *	is written one line at a time. Each line is only written once the buffer is
+ *	empty, and the next line is written by the BLE TX event after it has been
+ *	sent, which leaves the rest of the buffer free for the temperature readings.
+ *
+ * @param[in] gen
+ *	The function that writes each line of the report.
+ *
+ ******************************************************************************/
+static void app_report_start(APP_REPORT gen){
+	report_gen = gen;
+	report_line = 0;
+	app_report_next();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes the next line of the active report if the BLE buffer is empty.
+ *
+ * @details
+ *	If the LEUART is busy, the BLE TX event of the current transmission calls
+ *	this function again. ble_circ_pop() returns true when the LEUART is idle
+ *	and there is nothing left on the circular buffer to transmit.
+ *
+ ******************************************************************************/
+static void app_report_next(void){
+	if(report_gen == NULL || leuart_busy() || !ble_circ_pop(false)){
+		return;
+	}
+	if(report_gen(&report_line, report_str)){
+		ble_write(report_str);
+	} else {
+		report_gen = NULL;
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Freezes the event trace and starts sending it over BLE.
+ *
+ * @details
+ *	The trace is sent in binary packets, one at a time in the same way as a
+ *	report, and recording starts again once the last packet has been written.
+ *	A dump that is already running is not restarted.
+ *
+ ******************************************************************************/
+static void app_trace_start(void){
+	if(trace_dumping){
+		return;
+	}
+	trace_freeze();
+	trace_packet = 0;
+	trace_dumping = true;
+	app_trace_next();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes the next packet of the trace dump if the BLE link is idle.
+ *
+ * @details
+ *	A text report that is running is sent first and the dump carries on after
+ *	it. Packets are always sent whole, and the host skips the text between them.
+ *
+ ******************************************************************************/
+static void app_trace_next(void){
+	uint32_t len;
+
+	if(!trace_dumping || report_gen != NULL || leuart_busy() || !ble_circ_pop(false)){
+		return;
+	}
+	len = trace_dump_packet(&trace_packet, trace_buf);
+	if(len){
+		ble_write_raw(trace_buf, len);
+	} else {
+		trace_dumping = false;
+		trace_resume();
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes one line of the scheduler event counter report.
+ *
+ * @details
+ *	The first line is a header, followed by one line for every registered
+ *	event with its handle, posts, coalesced posts, dispatches and longest pending
+ *	time in us. The last line has the totals added up by the background
+ *	stats job after the most recent temperature reading.
+ *
+ * @param[in] line
+ *	The line to write, advanced past the line that was written.
+ *
+ * @param[in] str
+ *	The string the line is written to.
+ *
+ * @return
+ *	Returns false once every line has been written.
+ *
+ ******************************************************************************/
+static bool app_report_stats(uint32_t *line, char *str){
+	SCHEDULER_EVENT_STATS stats;
+
+	if(*line == 0){
+		sprintf(str, "#STATS ev post coal disp us\n");
+		(*line)++;
+		return true;
+	}
+	while(*line <= SCHEDULER_MAX_EVENTS){
+		uint32_t event = *line;
+		(*line)++;
+		if(scheduler_get_stats(event, &stats)){
+			sprintf(str, "%lu %lu %lu %lu %lu\n", (unsigned long)event,
+					(unsigned long)stats.posts, (unsigned long)stats.coalesced,
+					(unsigned long)stats.dispatches, (unsigned long)stats.max_pending);
+			return true;
+		}
+	}
+	if(*line == SCHEDULER_MAX_EVENTS + 1){
+		sprintf(str, "total %lu %lu\n", (unsigned long)stats_total_posts,
+				(unsigned long)stats_total_dispatches);
+		(*line)++;
+		return true;
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Background job that adds up the scheduler counters of every event.
+ *
+ * @details
+ *	Each slice adds up APP_STATS_SLICE events, and the totals used by the stats
+ *	report are only updated once every event has been added, so the report
+ *	never shows a partial sum.
+ *
+ * @param[in] job
+ *	The job, whose step is the last event handle added.
+ *
+ * @return
+ *	Returns true once every event has been added up.
+ *
+ ******************************************************************************/
+static bool app_stats_job(BG_JOB *job){
+	SCHEDULER_EVENT_STATS stats;
+
+	if(job->step == 0){
+		stats_sum_posts = 0;
+		stats_sum_dispatches = 0;
+	}
+	for(uint32_t i = 0; i < APP_STATS_SLICE && job->step < SCHEDULER_MAX_EVENTS; i++){
+		job->step++;
+		if(scheduler_get_stats(job->step, &stats)){
+			stats_sum_posts += stats.posts;
+			stats_sum_dispatches += stats.dispatches;
+		}
+	}
+	if(job->step < SCHEDULER_MAX_EVENTS){
+		return false;
+	}
+	stats_total_posts = stats_sum_posts;
+	stats_total_dispatches = stats_sum_dispatches;
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes one line of the handler run time report.
+ *
+ * @details
+ *	The first line is a header with the total number of violations, followed by
+ *	one line for every registered event with its handle, longest handler run
+ *	time in us, budget overruns, most dispatches waited through and the
+ *	number of times it was starved.
+ *
+ * @param[in] line
+ *	The line to write, advanced past the line that was written.
+ *
+ * @param[in] str
+ *	The string the line is written to.
+ *
+ * @return
+ *	Returns false once every line has been written.
+ *
+ ******************************************************************************/
+static bool app_report_budget(uint32_t *line, char *str){
+	SCHEDULER_EVENT_STATS stats;
+
+	if(*line == 0){
+		sprintf(str, "#BUDGET %lu ev run over rounds starved\n", (unsigned long)scheduler_violations());
+		(*line)++;
+		return true;
+	}
+	while(*line <= SCHEDULER_MAX_EVENTS){
+		uint32_t event = *line;
+		(*line)++;
+		if(scheduler_get_stats(event, &stats)){
+			sprintf(str, "%lu %lu %lu %lu %lu\n", (unsigned long)event,
+					(unsigned long)stats.max_run, (unsigned long)stats.overruns,
+					(unsigned long)stats.max_rounds, (unsigned long)stats.starved);
+			return true;
+		}
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes one line of the dispatch latency histogram report.
+ *
+ * @details
+ *	The first line is a header, followed by one line for every bucket with a
+ *	non-zero count, with the event handle, the bucket and its count. Bucket n holds
+ *	latencies from 2^(n-1) to 2^n - 1 us. The histogram of an
+ *	event is copied when its first bucket is reached, so each event is read
+ *	once per report.
+ *
+ * @param[in] line
+ *	The line to write, advanced past the line that was written.
+ *
+ * @param[in] str
+ *	The string the line is written to.
+ *
+ * @return
+ *	Returns false once every line has been written.
+ *
+ ******************************************************************************/
+static bool app_report_hist(uint32_t *line, char *str){
+	static uint16_t hist[SCHEDULER_HIST_BUCKETS];
+	uint32_t event;
+	uint32_t bucket;
+
+	if(*line == 0){
+		sprintf(str, "#HIST ev bucket count\n");
+		(*line)++;
+		return true;
+	}
+	while(*line <= SCHEDULER_MAX_EVENTS * SCHEDULER_HIST_BUCKETS){
+		event = (*line - 1) / SCHEDULER_HIST_BUCKETS + 1;
+		bucket = (*line - 1) % SCHEDULER_HIST_BUCKETS;
+		if(bucket == 0 && !scheduler_get_histogram(event, hist)){
+			*line += SCHEDULER_HIST_BUCKETS;
+			continue;
+		}
+		(*line)++;
+		if(hist[bucket] != 0){
+			sprintf(str, "%lu %lu %u\n", (unsigned long)event, (unsigned long)bucket, hist[bucket]);
+			return true;
+		}
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes one line of the tickless idle report.
+ *
+ * @details
+ *	The first line is a header, followed by one line for EM0 and each energy mode
+ *	the tickless idle can enter, with the number of times it was entered, how many
+ *	of those were instead of a deeper mode, the time spent in it in ms and the
+ *	percentage of the time since the residency was reset, followed by its measured
+ *	break-even time in us and how many times it was chosen on the moving average
+ *	of the idle time. For EM0 the count is the number of wakeups. The header
+ *	carries the moving average of the idle time.
+ *
+ * @param[in] line
+ *	The line to write, advanced past the line that was written.
+ *
+ * @param[in] str
+ *	The string the line is written to.
+ *
+ * @return
+ *	Returns false once every line has been written.
+ *
+ ******************************************************************************/
+static bool app_report_sleep(uint32_t *line, char *str){
+	SLEEP_DECISION_STATS stats;
+	SLEEP_RESIDENCY res;
+	SLEEP_LATENCY lat;
+	uint32_t elapsed;
+	uint32_t mode;
+
+	if(*line == 0){
+		sprintf(str, "#SLEEP idle %lu us em count demoted ms %% be_us pred\n",
+				(unsigned long)sleep_idle_average_us());
+		(*line)++;
+		return true;
+	}
+	mode = *line - 1;
+	if(mode > EM3){
+		return false;
+	}
+	(*line)++;
+	sleep_decision_stats(mode, &stats);
+	sleep_residency(mode, &res);
+	sleep_latency(mode, &lat);
+	elapsed = sleep_residency_elapsed();
+	if(elapsed == 0){
+		elapsed = 1;
+	}
+	sprintf(str, "EM%lu %lu %lu %lu %lu %lu %lu\n", (unsigned long)mode, (unsigned long)res.entries,
+			(unsigned long)stats.demoted, (unsigned long)((uint64_t)res.ticks * 1000 / SW_TIMER_HZ),
+			(unsigned long)((uint64_t)res.ticks * 100 / elapsed), (unsigned long)lat.break_even_us,
+			(unsigned long)stats.predicted);
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes one line of the sleep block owner report.
+ *
+ * @details
+ *	The first line is a header with the number of owners holding a block for
+ *	longer than they should, followed by one line for every registered owner
+ *	with its name, the blocks it holds, the blocks it has made, how long it has
+ *	been holding in ms and LEAK if that is longer than it should.
+ *
+ * @param[in] line
+ *	The line to write, advanced past the line that was written.
+ *
+ * @param[in] str
+ *	The string the line is written to.
+ *
+ * @return
+ *	Returns false once every line has been written.
+ *
+ ******************************************************************************/
+static bool app_report_owners(uint32_t *line, char *str){
+	const SLEEP_OWNER *owner;
+
+	if(*line == 0){
+		sprintf(str, "#OWNERS %lu name held total ms\n", (unsigned long)sleep_owner_leaks());
+		(*line)++;
+		return true;
+	}
+	owner = sleep_owner_get(*line - 1);
+	if(owner == NULL){
+		return false;
+	}
+	(*line)++;
+	sprintf(str, "%s %lu %lu %lu%s\n", owner->name, (unsigned long)owner->held,
+			(unsigned long)owner->total, (unsigned long)sleep_owner_held_ms(owner),
+			sleep_owner_leaking(owner) ? " LEAK" : "");
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes one line of the energy estimate report.
+ *
+ * @details
+ *	The first line is a header with the number of measurement cycles, followed
+ *	by the charge in nC, energy in uJ and length in ms of the last cycle, the
+ *	average charge of a cycle, and the average current in nA with the battery
+ *	life in hours it gives. Then come the thousands of core cycles run in the
+ *	last cycle, the core clock and the number of times it has changed, and the
+ *	time the DC-DC has spent at each level with the number of level changes.
+ *	The last line is the RAM retained in EM2/EM3 and the datasheet estimate of
+ *	the sleep current saved by powering down the rest.
+ *
+ * @param[in] line
+ *	The line to write, advanced past the line that was written.
+ *
+ * @param[in] str
+ *	The string the line is written to.
+ *
+ * @return
+ *	Returns false once every line has been written.
+ *
+ ******************************************************************************/
+static bool app_report_energy(uint32_t *line, char *str){
+	ENERGY_REPORT report;
+	DCDC_STATS dcdc;
+
+	energy_report(&report);
+	switch(*line){
+	case 0:
+		sprintf(str, "#ENERGY %lu cycles\n", (unsigned long)report.cycles);
+		break;
+	case 1:
+		sprintf(str, "last %lu nC %lu uJ %lu ms\n", (unsigned long)report.last_nc,
+				(unsigned long)report.last_uj, (unsigned long)report.last_ms);
+		break;
+	case 2:
+		sprintf(str, "mean %lu nC\n", (unsigned long)report.mean_nc);
+		break;
+	case 3:
+		sprintf(str, "avg %lu nA life %lu h\n", (unsigned long)report.average_na,
+				(unsigned long)report.life_hours);
+		break;
+	case 4:
+		sprintf(str, "core %lu kcyc %lu kHz %lu changes\n", (unsigned long)report.last_kcycles,
+				(unsigned long)(perf_core_hz() / 1000), (unsigned long)perf_changes());
+		break;
+	case 5:
+		dcdc_stats(&dcdc);
+		sprintf(str, "dcdc lp %lu ms ln %lu ms %lu changes\n", (unsigned long)dcdc.ms[DCDC_LOW_POWER],
+				(unsigned long)dcdc.ms[DCDC_LOW_NOISE], (unsigned long)dcdc.changes);
+		break;
+	case 6:
+		sprintf(str, "ram %lu k retained saves %lu nA\n", (unsigned long)report.ram_kbytes,
+				(unsigned long)report.ram_saved_na);
+		break;
+	default:
+		return false;
+	}
+	(*line)++;
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes the lines of the energy mode sweep table.
+ *
+ * @details
+ *	One row per level swept, with the readings completed and missed during the
+ *	dwell, the wake latency of the level's mode and the residency of each mode.
+ *
+ ******************************************************************************/
+static bool app_report_sweep(uint32_t *line, char *str){
+	SWEEP_RESULT result;
+
+	if(*line == 0){
+		sprintf(str, "#SWEEP em rd miss wake_us em0%% em1%% em2%% em3%%\n");
+	} else if(*line <= sweep_levels()){
+		sweep_result(*line - 1, &result);
+		sprintf(str, "EM%lu %lu %lu %lu %lu %lu %lu %lu\n", (unsigned long)(*line - 1),
+				(unsigned long)result.readings, (unsigned long)result.missed,
+				(unsigned long)result.wake_us, (unsigned long)result.percent[EM0],
+				(unsigned long)result.percent[EM1], (unsigned long)result.percent[EM2],
+				(unsigned long)result.percent[EM3]);
+	} else {
+		return false;
+	}
+	(*line)++;
+	return true;
+}
+
 /***************************************************************************//**
  * @brief
  *	The event handler for the LETIMER0 UF event
  *
  * @details
- *	This function removes the underflow event bit from the scheduler, and has a
- *	check to ensure that the event was successfully handled. This callback function
- *	is primarily set by the interrupt handlers, but can also be called by the completion
- *	of processing a state.
+ *	This function takes the next underflow off of the LETIMER event queue and starts
+ *	a temperature read of the Si7021. The scheduler removes the underflow event bit
+ *	before dispatching to this handler. If a read is still in progress the underflow
+ *	is left on the queue, and the Si7021 done event schedules it again.
  *
  *
  ******************************************************************************/
 void scheduled_letimer0_uf_cb (void){
-	si7021_i2c_read(SI7021_READ_CB);
-	remove_scheduled_event(LETIMER0_UF_CB);
+	uint32_t uf_count;
+
+	if(si7021_busy()){
+		return;
+	}
+	if(event_queue_get(letimer_event_queue(), letimer0_uf_event, &uf_count)){
+		si7021_i2c_read(si7021_read_event);
+	}
 }
 
 /***************************************************************************//**
@@ -126,15 +773,14 @@ void scheduled_letimer0_uf_cb (void){
  *	The event handler for the LETIMER0 comp0 event
  *
  * @details
- *	This function removes the comp0 event bit from the scheduler, and has a
- *	check to ensure that the event was successfully handled. This callback function
+ *	The scheduler removes the comp0 event bit before dispatching to this handler,
+ *	and the handler asserts since the comp0 interrupt is not enabled. This callback function
  *	is primarily set by the interrupt handlers, but can also be called by the completion
  *	of processing a state.
  *
  *
  ******************************************************************************/
 void scheduled_letimer0_comp0_cb (void){
-	remove_scheduled_event(LETIMER0_COMP0_CB);
 	EFM_ASSERT(false);
 }
 
@@ -143,15 +789,14 @@ void scheduled_letimer0_comp0_cb (void){
  *	The event handler for the LETIMER0 comp1 event
  *
  * @details
- *	This function removes the comp1 event bit from the scheduler, and has a
- *	check to ensure that the event was successfully handled. This callback function
+ *	The scheduler removes the comp1 event bit before dispatching to this handler,
+ *	and the handler asserts since the comp1 interrupt is not enabled. This callback function
  *	is primarily set by the interrupt handlers, but can also be called by the completion
  *	of processing a state.
  *
  *
  ******************************************************************************/
 void scheduled_letimer0_comp1_cb (void){
-	remove_scheduled_event(LETIMER0_COMP1_CB);
 	EFM_ASSERT(false);
 }
 
@@ -160,33 +805,73 @@ void scheduled_letimer0_comp1_cb (void){
  *	The event handler for the Si7021 temp_complete event
  *
  * @details
- *	This function removes the temp_complete event bit from the scheduler, and based
- *	on the temperature, turns LED0 on or off. This callback function is primarily
- *	set by the interrupt handlers, but can also be called by the completion of
- *	processing a state.
+ *	The scheduler removes the temp_complete event bit before dispatching to this
+ *	handler, which takes the temperature code off of the I2C event queue, and based
+ *	on the temperature, turns LED0 on or off. The completed reading checks in with
+ *	the watchdog as the sampling cycle client and queues the background stats job.
+ *	The reading ends the measurement cycle of the energy estimate and counts
+ *	towards the level of a running energy mode sweep. The first
+ *	reading after a sleep block owner starts leaking sends a notice.
+ *	While hibernating the reading is sent with the time from the wakeup to the
+ *	transmit and the time the previous wakeup spent awake, and nothing else is done.
+ *	Any underflow that arrived while the read was in progress is then scheduled again.
  *
  ******************************************************************************/
 void si7021_temp_done_evt(void){
 	float temp;
-	temp = si7021_temp();
+	uint32_t code;
+	char unit;
+	bool hot;
+
+	if(!event_queue_get(i2c_event_queue(), si7021_read_event, &code)){
+		return;
+	}
+	temp = si7021_temp_convert(code);
 	if(celsius){
 		temp = (temp-32)*(5.0/9.0);
-		if(temp > 30.0){
-			GPIO_PinOutSet(LED0_PORT, LED0_PIN);
-		} else {
-			GPIO_PinOutClear(LED0_PORT, LED0_PIN);
-		}
-		sprintf(str, "temp = %3.1f C\n", temp);
+		unit = 'C';
+		hot = temp > 30.0;
 	} else {
-		if(temp > 80.0){
-			GPIO_PinOutSet(LED0_PORT, LED0_PIN);
-		} else {
-			GPIO_PinOutClear(LED0_PORT, LED0_PIN);
-		}
-		sprintf(str, "temp = %3.1f F\n", temp);
+		unit = 'F';
+		hot = temp > 80.0;
+	}
+	if(hot){
+		GPIO_PinOutSet(LED0_PORT, LED0_PIN);
+	} else {
+		GPIO_PinOutClear(LED0_PORT, LED0_PIN);
 	}
+	if(hibernating){
+		sprintf(str, "temp = %3.1f %c wake %lu ms awake %lu ms\n", temp, unit,
+				(unsigned long)hibernate_ms_since_wake(), (unsigned long)hib_state.awake_ms);
+		ble_write(str);
+		return;
+	}
+	energy_cycle();
+	sweep_reading();
+	sprintf(str, "temp = %3.1f %c\n", temp, unit);
 	ble_write(str);
-	remove_scheduled_event(SI7021_READ_CB);
+	if(sleep_owner_leaks() == 0){
+		leak_reported = false;
+	} else if(!leak_reported){
+		leak_reported = true;
+		ble_write(leak_str);
+	}
+	watchdog_checkin(sample_wdog);
+	background_submit(&stats_job, app_stats_job);
+	event_queue_notify(letimer_event_queue());
+}
+
+/***************************************************************************//**
+ * @brief
+ *	The event handler for the Si7021 power up event
+ *
+ * @details
+ *	Posted by the software timer once a sensor powered down for an EM3 sleep
+ *	has had time to power up, and starts the read that was waiting for it.
+ *
+ ******************************************************************************/
+void scheduled_si7021_power_cb (void){
+	si7021_powered();
 }
 
 /***************************************************************************//**
@@ -194,25 +879,111 @@ void si7021_temp_done_evt(void){
  *	The event handler for the boot up event
  *
  * @details
- *	This function removes the boot up event bit from the scheduler, which occurs
- *	after the app peripheral setup in app.c. This function can be used as to test
- *	the BLE module, it then tests the circular buffer, and sends several strings
- *	to be transmitted.
+ *	The boot up event runs the boot task, which is started at the end of the app
+ *	peripheral setup in app.c, and is posted again each time the boot task has
+ *	something to wait for.
  *
  ******************************************************************************/
 void scheduled_boot_up_cb (void){
-	remove_scheduled_event(BOOT_UP_CB);
+	task_run(&boot_task);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	The boot task
+ *
+ * @details
+ *	This task can be used as to test the BLE module, it then tests the circular
+ *	buffer, and sends several strings to be transmitted. The wait for the BLE
+ *	module to store its new name sleeps on the software timer instead of busy
+ *	waiting in EM0.
+ *
+ * @param[in] task
+ *	Pointer to the boot task.
+ *
+ * @return
+ *	Returns true once the boot sequence has finished.
+ *
+ ******************************************************************************/
+static bool app_boot_task(TASK *task){
+#ifdef BLE_TEST_ENABLED
+	bool ble_test_ret;
+#endif
 
+	TASK_BEGIN(task);
 #ifdef BLE_TEST_ENABLED
-	bool ble_test_ret = ble_test("MattsBLE");
+	ble_test_ret = ble_test("MattsBLE");
 	EFM_ASSERT(ble_test_ret);
-	timer_delay(2000);
+	TASK_DELAY(task, 2000);
 #endif
 	circular_buff_test();
+#ifdef SCHEDULER_BENCH_ENABLED
+	scheduler_dispatch_bench();
+	scheduler_atomic_bench();
+#endif
+#ifdef EVENT_QUEUE_TEST_ENABLED
+	letimer_event_queue_test();
+#endif
+#ifdef SW_TIMER_TEST_ENABLED
+	sw_timer_test();
+#endif
+#ifdef SLEEP_ARBITER_TEST_ENABLED
+	sleep_arbiter_test();
+#endif
 	ble_write("\nHello World\n");
 	ble_write("ADC Lab\n");
 	ble_write("Matt Hartnett\n");
+	if(watchdog_caused_reset()){
+		ble_write("Watchdog reset\n");
+	}
+	watchdog_start();
 	letimer_start(LETIMER0, true);
+#ifdef SWEEP_BENCH_ENABLED
+	sweep_open(SYSTEM_BLOCK_EM, (uint32_t)(PWM_PER * 1000));
+	task_start(&sweep_task);
+#endif
+	TASK_END(task);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	The event handler for the sweep event
+ *
+ * @details
+ *	The sweep event runs the energy mode sweep task, which is only started by
+ *	the boot task when SWEEP_BENCH_ENABLED is defined.
+ *
+ ******************************************************************************/
+void scheduled_sweep_cb (void){
+	task_run(&sweep_task);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	The energy mode sweep task
+ *
+ * @details
+ *	Holds each level from EM0 to the deepest mode the application allows for
+ *	SWEEP_DWELL_MS while the temperature is sampled as usual, then sends the
+ *	table of results. Modes from SYSTEM_BLOCK_EM down are blocked by the
+ *	application the whole time, so they are not swept.
+ *
+ * @param[in] task
+ *	Pointer to the sweep task.
+ *
+ * @return
+ *	Returns true once the table has been started.
+ *
+ ******************************************************************************/
+static bool app_sweep_task(TASK *task){
+	TASK_BEGIN(task);
+	for(sweep_level = EM0; sweep_level < sweep_levels(); sweep_level++){
+		sweep_begin(sweep_level);
+		TASK_DELAY(task, SWEEP_DWELL_MS);
+		sweep_end();
+	}
+	app_report_start(app_report_sweep);
+	TASK_END(task);
 }
 
 
@@ -221,14 +992,27 @@ void scheduled_boot_up_cb (void){
  *	The event handler for the BLE TX event
  *
  * @details
- *	This function removes the BLE TX event bit from the scheduler, which is
- *	used to signify that the transmission over the LEUART has been successfully
- *	completed, and then it pops the next string off of the circular buffer.
+ *	The BLE TX event is used to signify that the transmission over the LEUART has been successfully
+ *	completed, and then it pops the next string off of the circular buffer. Once the
+ *	buffer is empty, the BLE TX watchdog client checks in, and the next line of
+ *	an active report or the next packet of a trace dump is written. While
+ *	hibernating, the device goes back into EM4H once everything has been sent
+ *	and no reading is in progress.
  *
  ******************************************************************************/
 void scheduled_ble_tx_cb (void){
-	remove_scheduled_event(BLE_TX_CB);
+	uint32_t sent_bytes;
+
+	event_queue_get(leuart_event_queue(), ble_tx_event, &sent_bytes);
 	ble_circ_pop(false);
+	if(!leuart_busy()){
+		watchdog_checkin(ble_tx_wdog);
+	}
+	app_report_next();
+	app_trace_next();
+	if(hibernating && !leuart_busy() && !si7021_busy() && report_gen == NULL && !trace_dumping){
+		app_hibernate();
+	}
 }
 
 
@@ -237,19 +1021,54 @@ void scheduled_ble_tx_cb (void){
  *	The event handler for the BLE RX event
  *
  * @details
- *	This function removes the BLE RX event bit from the scheduler, which is
- *	used to signify that a complete command (with a START and a SIG frame) has
+ *	The BLE RX event is used to signify that a complete command (with a START and a SIG frame) has
  *	been received successfully. If the command matches with the celsius/fahrenheit
- *	command, then it begins to display in the format specified.
+ *	command, then it begins to display in the format specified. The stats command
+ *	sends the scheduler event counters, the histogram command sends the dispatch
+ *	latency histograms, the budget command sends the handler run time and
+ *	starvation counters, and the sleep command sends the tickless idle counters
+ *	and energy mode residency, which the sleep clear command resets. The owners
+ *	command sends the blocks held by each sleep block owner, and the energy command
+ *	sends the estimated charge of each measurement cycle. The hibernate command
+ *	stops the LETIMER and hibernates in EM4H between readings once the last
+ *	message has been sent, until the next cold boot.
+ *	The trace command freezes the event trace and dumps it in binary.
  *
  ******************************************************************************/
 void scheduled_ble_rx_cb (void){
-	remove_scheduled_event(BLE_RX_CB);
+	uint32_t rx_len;
+
+	if(!event_queue_get(leuart_event_queue(), ble_rx_event, &rx_len)){
+		return;
+	}
 	strcpy(str, rx_str());
 	if(strcmp(str, c_str) == 0){
 		celsius = true;
 	} else if (strcmp(str, f_str) == 0){
 		celsius = false;
+	} else if (strcmp(str, stats_str) == 0){
+		app_report_start(app_report_stats);
+	} else if (strcmp(str, budget_str) == 0){
+		app_report_start(app_report_budget);
+	} else if (strcmp(str, hist_str) == 0){
+		app_report_start(app_report_hist);
+	} else if (strcmp(str, sleep_str) == 0){
+		app_report_start(app_report_sleep);
+	} else if (strcmp(str, sleep_clear_str) == 0){
+		sleep_decision_reset();
+		sleep_residency_reset();
+	} else if (strcmp(str, trace_str) == 0){
+		app_trace_start();
+	} else if (strcmp(str, owners_str) == 0){
+		app_report_start(app_report_owners);
+	} else if (strcmp(str, energy_str) == 0){
+		app_report_start(app_report_energy);
+	} else if (strcmp(str, hibernate_str) == 0 && !hibernating){
+		letimer_start(LETIMER0, false);
+		hib_state.flags = celsius ? HIBERNATE_FLAG_CELSIUS : 0;
+		hib_state.wakes = 0;
+		hibernating = true;
+		ble_write(hibernating_str);
 	}
 }
 
@@ -0,0 +1,181 @@
+/**
+ * @file background.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Background jobs run in slices while no scheduler events are pending
+ *
+ * @details
+ *  Housekeeping work that has no deadline of its own is queued here instead of
+ *  being posted as a scheduler event, so it never delays the event handlers.
+ *  The main loop runs one slice of the job at the head of the queue only when
+ *  no events are pending, and dispatches any event posted during the slice
+ *  before the next one, so a job is preempted at every slice boundary. Jobs
+ *  take turns one slice at a time.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "background.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static BG_JOB *bg_head;
+static BG_JOB *bg_tail;
+static uint32_t cycles_per_us;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Opens the background job queue.
+ *
+ * @note
+ *	Slices are timed with the DWT cycle counter, which is started by
+ *	scheduler_open(), and the core clock must be set before this is called.
+ *
+ ******************************************************************************/
+void background_open(void){
+	bg_head = NULL;
+	bg_tail = NULL;
+	background_clock_set(CMU_ClockFreqGet(cmuClock_CORE));
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets the core clock the slice lengths are converted with.
+ *
+ * @details
+ *	The longest slice of each job is kept in cycles, which mostly do not depend
+ *	on the clock, so the predicted time of a slice follows the new clock.
+ *
+ * @param[in] core_hz
+ *   The core clock frequency.
+ *
+ ******************************************************************************/
+void background_clock_set(uint32_t core_hz){
+	cycles_per_us = core_hz / 1000000;
+	if(cycles_per_us == 0){
+		cycles_per_us = 1;
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Queues a background job to run from its first slice.
+ *
+ * @details
+ *	A job that is already queued is left where it is, so submitting it again
+ *	before it has finished does not restart it. The longest slice seen is kept
+ *	between runs of the same job, and a job that has never run is assumed to
+ *	take BACKGROUND_FIRST_SLICE cycles.
+ *
+ * @note
+ *	Must be called from the main loop, not from an interrupt handler.
+ *
+ * @param[in] job
+ *   Pointer to the job, which must stay valid until it has finished.
+ *
+ * @param[in] fn
+ *   The function that runs one slice of the job.
+ *
+ ******************************************************************************/
+void background_submit(BG_JOB *job, BG_SLICE fn){
+	EFM_ASSERT(fn != NULL);
+
+	if(job->queued){
+		return;
+	}
+	job->fn = fn;
+	job->step = 0;
+	if(job->slice_max == 0){
+		job->slice_max = BACKGROUND_FIRST_SLICE;
+	}
+	job->next = NULL;
+	job->queued = true;
+	if(bg_tail == NULL){
+		bg_head = job;
+	} else {
+		bg_tail->next = job;
+	}
+	bg_tail = job;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Runs one slice of the job at the head of the queue.
+ *
+ * @details
+ *	Nothing is run while a scheduler event is pending. The slice is also put
+ *	off if its predicted length, the longest slice the job has taken so far,
+ *	would not finish BACKGROUND_MARGIN_US before the next known deadline, so
+ *	the core can go back to sleep and wake up in time for it. A job that has
+ *	not finished goes to the back of the queue.
+ *
+ * @param[in] idle_ms
+ *   Milliseconds until the next known deadline, or SLEEP_IDLE_UNKNOWN.
+ *
+ * @return
+ *   Returns true if a slice was run, so the main loop should check for events
+ *   again before sleeping.
+ *
+ ******************************************************************************/
+bool background_run(uint32_t idle_ms){
+	BG_JOB *job = bg_head;
+	uint32_t start;
+	uint32_t cycles;
+	bool done;
+
+	if(job == NULL || get_scheduled_events()){
+		return false;
+	}
+	if(idle_ms < SLEEP_IDLE_UNKNOWN / 1000 &&
+			job->slice_max / cycles_per_us + BACKGROUND_MARGIN_US > idle_ms * 1000){
+		job->skipped++;
+		return false;
+	}
+
+	start = DWT->CYCCNT;
+	done = job->fn(job);
+	cycles = DWT->CYCCNT - start;
+	if(cycles > job->slice_max){
+		job->slice_max = cycles;
+	}
+	job->slices++;
+
+	bg_head = job->next;
+	job->next = NULL;
+	if(bg_head == NULL){
+		bg_tail = NULL;
+	}
+	if(done){
+		job->queued = false;
+	} else if(bg_tail == NULL){
+		bg_head = job;
+		bg_tail = job;
+	} else {
+		bg_tail->next = job;
+		bg_tail = job;
+	}
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns whether any background job is queued.
+ *
+ ******************************************************************************/
+bool background_pending(void){
+	return bg_head != NULL;
+}
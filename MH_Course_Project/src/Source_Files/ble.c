@@ -93,7 +93,7 @@ void ble_open(uint32_t tx_event, uint32_t rx_event){
  *   Pointer to the string to be transmitted.
  *
  * @param[in] tx_done_event
- *   The event with one hot encoding to signify that a transmit has been
+ *   The scheduler event handle to signify that a transmit has been
  *   completed.
  *
  ******************************************************************************/
@@ -103,6 +103,34 @@ void ble_write(char* string){
  	ble_circ_pop(false);
 }
 
+/***************************************************************************//**
+ * @brief Transmits a binary packet over the BLE module.
+ *
+ * @details
+ *	The circular buffer holds strings, so binary data that can contain NULL
+ *	characters is passed straight to the LEUART instead. The packet is only
+ *	sent when the LEUART is idle and no strings are waiting on the buffer, so
+ *	it cannot be interleaved with a string.
+ *
+ * @param[in] *data
+ *   Pointer to the packet, which is copied before transmitting.
+ *
+ * @param[in] len
+ *   The length of the packet, at most CSIZE bytes.
+ *
+ * @return
+ *   Returns false if the packet was not sent because the link was busy.
+ *
+ ******************************************************************************/
+
+bool ble_write_raw(const uint8_t *data, uint32_t len){
+	if(leuart_busy() || ble_circ_space() != CSIZE){
+		return false;
+	}
+	leuart_start_len(HM10_LEUART0, (const char *)data, len);
+	return true;
+}
+
 /***************************************************************************//**
  * @brief
  *   BLE Test performs two functions.  First, it is a Test Driven Development
@@ -51,5 +51,8 @@ void cmu_open(void){
 
 		// Enable clock for LEUART
 		CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_LFXO);
+
+		// Route the ULFRCO to the RTCC clock tree for the software timers
+		CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_ULFRCO);
 }
 
@@ -0,0 +1,293 @@
+/**
+ * @file dcdc.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief DC-DC converter level chosen by the votes of the drivers
+ *
+ * @details
+ *  The DC-DC only needs to be quiet while something sensitive to supply noise
+ *  is running, such as a transmit to the BLE module. Drivers vote for
+ *  DCDC_LOW_NOISE around that work, and the rest of the time the converter
+ *  runs at DCDC_LOW_POWER. The time spent at each level and the number of
+ *  changes are kept so the gain can be measured against DCDC_FIXED_ENABLED.
+ *
+ *  Both levels are the low noise mode of the converter, with discontinuous or
+ *  continuous conduction. The low power mode of the converter only supports
+ *  the load of EM2/EM3, and the hardware already switches to it there.
+ *
+ *  Changing the conduction mode passes the converter through bypass and waits
+ *  for it, so it is only done from the main loop with interrupts enabled. Votes
+ *  made from interrupt handlers are applied by dcdc_update(), and low noise is
+ *  kept for DCDC_HOLD_MS after the last release so a burst of transmits only
+ *  changes the mode once each way.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "dcdc.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static DCDC_CLIENT *client_head;
+static DCDC_CLIENT *client_tail;
+static uint32_t current_level;
+static uint32_t level_since;
+static uint32_t level_ticks[DCDC_LEVELS];
+static uint32_t changes;
+static SW_TIMER hold_timer;
+static bool holding;
+static volatile bool update_pending;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+static void dcdc_account(void);
+static void dcdc_set(uint32_t level);
+static uint32_t dcdc_wanted(void);
+
+/***************************************************************************//**
+ * @brief
+ *	Adds the time since the last call to the time spent at the current level.
+ *
+ ******************************************************************************/
+static void dcdc_account(void){
+	uint32_t now = sw_timer_now();
+
+	level_ticks[current_level] += now - level_since;
+	level_since = now;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets the conduction mode of the DC-DC for a level.
+ *
+ * @details
+ *	The reverse current and RCO band of the converter are set to the defaults
+ *	for the conduction mode by emlib.
+ *
+ * @note
+ *	Waits for the converter to go through bypass, so it must not be called from
+ *	an interrupt handler or a critical section.
+ *
+ * @param[in] level
+ *   One of enum dcdc_level.
+ *
+ ******************************************************************************/
+static void dcdc_set(uint32_t level){
+	dcdc_account();
+	if(level == current_level){
+		return;
+	}
+	if(level == DCDC_LOW_NOISE){
+		EMU_DCDCConductionModeSet(emuDcdcConductionMode_ContinuousLN, true);
+	} else {
+		EMU_DCDCConductionModeSet(emuDcdcConductionMode_DiscontinuousLN, true);
+	}
+	current_level = level;
+	changes++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the highest level any client has voted for.
+ *
+ * @details
+ *	With DCDC_FIXED_ENABLED this is always DCDC_LOW_NOISE.
+ *
+ ******************************************************************************/
+static uint32_t dcdc_wanted(void){
+	uint32_t level = DCDC_LOW_POWER;
+
+#ifdef DCDC_FIXED_ENABLED
+	level = DCDC_LOW_NOISE;
+#else
+	for(DCDC_CLIENT *c = client_head; c != NULL; c = c->next){
+		if(c->level > level){
+			level = c->level;
+		}
+	}
+#endif
+	return level;
+}
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Opens the DC-DC policy with no votes.
+ *
+ * @note
+ *	main() initialises the DC-DC in low noise mode with continuous conduction.
+ *	The time at each level and the hold after a release are kept with the
+ *	software timers, so sw_timer_open() must be called first.
+ *
+ ******************************************************************************/
+void dcdc_open(void){
+	client_head = NULL;
+	client_tail = NULL;
+	changes = 0;
+	for(uint32_t i = 0; i < DCDC_LEVELS; i++){
+		level_ticks[i] = 0;
+	}
+	hold_timer.active = false;
+	holding = false;
+	EMU_DCDCModeSet(emuDcdcMode_LowNoise);
+	current_level = DCDC_LOW_NOISE;
+	level_since = sw_timer_now();
+	dcdc_set(dcdc_wanted());
+	update_pending = false;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Registers a client that can vote for a DC-DC level.
+ *
+ * @details
+ *	Registering a client that is already registered does nothing.
+ *
+ * @param[in] client
+ *   Pointer to the client, which must stay valid while it is registered.
+ *
+ * @param[in] name
+ *   The name shown for the client.
+ *
+ ******************************************************************************/
+void dcdc_client_register(DCDC_CLIENT *client, const char *name){
+	for(DCDC_CLIENT *c = client_head; c != NULL; c = c->next){
+		if(c == client){
+			return;
+		}
+	}
+	client->next = NULL;
+	client->name = name;
+	client->level = DCDC_LOW_POWER;
+	client->votes = 0;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	if(client_tail == NULL){
+		client_head = client;
+	} else {
+		client_tail->next = client;
+	}
+	client_tail = client;
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Votes for a DC-DC level until the client releases it.
+ *
+ * @details
+ *	A second vote from the same client replaces the first. From the main loop
+ *	the level is changed before returning, from an interrupt handler the vote
+ *	is only recorded and applied by the next dcdc_update().
+ *
+ * @note
+ *	Must not be called from the main loop inside a critical section.
+ *
+ * @param[in] client
+ *   The registered client voting.
+ *
+ * @param[in] level
+ *   One of enum dcdc_level.
+ *
+ ******************************************************************************/
+void dcdc_vote(DCDC_CLIENT *client, uint32_t level){
+	EFM_ASSERT(level < DCDC_LEVELS);
+
+	client->level = level;
+	client->votes++;
+	update_pending = true;
+	if(!CORE_InIrqContext()){
+		dcdc_update();
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Releases the client's vote, leaving it at DCDC_LOW_POWER.
+ *
+ * @details
+ *	Only records the release, which dcdc_update() applies after DCDC_HOLD_MS.
+ *	Can be called from an interrupt handler.
+ *
+ * @param[in] client
+ *   The registered client releasing its vote.
+ *
+ ******************************************************************************/
+void dcdc_release(DCDC_CLIENT *client){
+	client->level = DCDC_LOW_POWER;
+	update_pending = true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Moves the DC-DC to the highest level voted for.
+ *
+ * @details
+ *	A higher level is set straight away. A lower level starts the hold timer
+ *	and is only set once it has expired with no new vote in between, and the
+ *	expiry wakes the core so the main loop calls this again.
+ *
+ * @note
+ *	Called by the main loop each time round, before it sleeps.
+ *
+ ******************************************************************************/
+void dcdc_update(void){
+	uint32_t level;
+
+	if(!update_pending && !(holding && !hold_timer.active)){
+		return;
+	}
+	update_pending = false;
+	level = dcdc_wanted();
+	if(level >= current_level){
+		if(holding){
+			sw_timer_stop(&hold_timer);
+			holding = false;
+		}
+		dcdc_set(level);
+	} else if(!holding){
+		holding = true;
+		sw_timer_start(&hold_timer, SCHEDULER_NO_EVENT, DCDC_HOLD_MS, 0);
+	} else if(!hold_timer.active){
+		holding = false;
+		dcdc_set(level);
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the level the DC-DC is at, one of enum dcdc_level.
+ *
+ ******************************************************************************/
+uint32_t dcdc_level(void){
+	return current_level;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of level changes and the time spent at each level.
+ *
+ * @param[out] out
+ *   Pointer to the struct the counters are copied to.
+ *
+ ******************************************************************************/
+void dcdc_stats(DCDC_STATS *out){
+	dcdc_account();
+	out->changes = changes;
+	for(uint32_t i = 0; i < DCDC_LEVELS; i++){
+		out->ms[i] = (uint64_t)level_ticks[i] * 1000 / SW_TIMER_HZ;
+	}
+}
@@ -0,0 +1,183 @@
+/**
+ * @file energy.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Estimate of the energy used by each measurement cycle
+ *
+ * @details
+ *  At the end of each measurement cycle the energy mode residency, the core
+ *  clock cycles run, the time spent in I2C transactions and the bytes sent
+ *  over the LEUART since the last cycle are run through the model in energy_model.c with the calibration table
+ *  of the board, giving the charge and energy of the cycle and the battery life
+ *  at the average current so far. The EM2 and EM3 currents of the board assume
+ *  all of RAM is retained, so the retention current of the RAM the linker
+ *  script leaves out is taken off them.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "energy.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static ENERGY_CALIBRATION energy_cal = ENERGY_CAL_BOARD;
+static uint32_t ram_saved_na;
+static ENERGY_SAMPLE counters;
+static ENERGY_SAMPLE last_sample;
+static uint64_t total_pc;
+static uint64_t total_ms;
+static uint64_t last_pc;
+static uint32_t cycles;
+static uint32_t counted_cyccnt;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+static void energy_counters(ENERGY_SAMPLE *now);
+static uint32_t energy_delta(uint32_t now, uint32_t before);
+static uint32_t energy_ram_retained(void);
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Opens the energy estimator, starting the first cycle from now.
+ *
+ * @details
+ *	Each 16k of RAM above __ram_retained_end is powered down by main(), so its
+ *	retention current, BOARD_RAM_RETAIN_NA, is taken off the EM2 and EM3
+ *	currents of the calibration. This is the datasheet figure, not a
+ *	measurement of the board.
+ *
+ * @note
+ *	Must be called after the residency has been reset with the RTCC running,
+ *	and after i2c_open() and leuart_open() have cleared their counters.
+ *
+ ******************************************************************************/
+void energy_open(void){
+	EFM_ASSERT(ENERGY_MODES == MAX_ENERGY_MODES);
+
+	energy_cal = (ENERGY_CALIBRATION)ENERGY_CAL_BOARD;
+	ram_saved_na = (SRAM_SIZE - energy_ram_retained()) / ENERGY_RAM_BLOCK_BYTES * BOARD_RAM_RETAIN_NA;
+	EFM_ASSERT(ram_saved_na < energy_cal.mode_na[EM3]);
+	energy_cal.mode_na[EM2] -= ram_saved_na;
+	energy_cal.mode_na[EM3] -= ram_saved_na;
+
+	energy_counters(&counters);
+	for(uint32_t i = 0; i < ENERGY_MODES; i++){
+		last_sample.mode_ms[i] = 0;
+	}
+	last_sample.i2c_ms = 0;
+	last_sample.leuart_bytes = 0;
+	last_sample.core_kcycles = 0;
+	counted_cyccnt = DWT->CYCCNT;
+	total_pc = 0;
+	total_ms = 0;
+	last_pc = 0;
+	cycles = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Ends a measurement cycle and adds its charge to the estimate.
+ *
+ * @details
+ *	The cycle is everything since the previous call. A counter that has gone
+ *	down since then has been cleared, by #SLEEPCLR! for the residency, so all
+ *	of its current value is counted. The cycle counter is counted in whole
+ *	thousands, and stops while the core sleeps, so a cycle must run fewer than
+ *	2^32 core cycles for it not to wrap.
+ *
+ ******************************************************************************/
+void energy_cycle(void){
+	ENERGY_SAMPLE now;
+
+	energy_counters(&now);
+	for(uint32_t i = 0; i < ENERGY_MODES; i++){
+		last_sample.mode_ms[i] = energy_delta(now.mode_ms[i], counters.mode_ms[i]);
+	}
+	last_sample.i2c_ms = energy_delta(now.i2c_ms, counters.i2c_ms);
+	last_sample.leuart_bytes = energy_delta(now.leuart_bytes, counters.leuart_bytes);
+	last_sample.core_kcycles = (DWT->CYCCNT - counted_cyccnt) / 1000;
+	counted_cyccnt += last_sample.core_kcycles * 1000;
+	counters = now;
+
+	last_pc = energy_model_charge_pc(&energy_cal, &last_sample);
+	total_pc += last_pc;
+	total_ms += energy_model_sample_ms(&last_sample);
+	cycles++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the estimate of the last cycle and of every cycle so far.
+ *
+ * @param[out] report
+ *   Pointer to the struct the estimate is written to.
+ *
+ ******************************************************************************/
+void energy_report(ENERGY_REPORT *report){
+	report->cycles = cycles;
+	report->last_nc = last_pc / 1000;
+	report->mean_nc = cycles ? total_pc / cycles / 1000 : 0;
+	report->last_uj = energy_model_uj(&energy_cal, last_pc);
+	report->last_ms = energy_model_sample_ms(&last_sample);
+	report->last_kcycles = last_sample.core_kcycles;
+	report->average_na = total_ms ? total_pc / total_ms : 0;
+	report->life_hours = energy_model_life_hours(&energy_cal, report->average_na);
+	report->ram_kbytes = energy_ram_retained() / 1024;
+	report->ram_saved_na = ram_saved_na;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the RAM kept powered in EM2/EM3.
+ *
+ * @details
+ *	The size of the RAM region of the linker script, which is all of RAM when
+ *	it is linked with __ram_retained_size set to 0x40000 for comparison.
+ *
+ ******************************************************************************/
+static uint32_t energy_ram_retained(void){
+	return (uint32_t)&__ram_retained_end - SRAM_BASE;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Reads the running counters the cycles are measured from.
+ *
+ * @param[out] now
+ *   Pointer to the struct the counters are written to, in ms and bytes.
+ *
+ ******************************************************************************/
+static void energy_counters(ENERGY_SAMPLE *now){
+	SLEEP_RESIDENCY res;
+
+	for(uint32_t i = 0; i < ENERGY_MODES; i++){
+		sleep_residency(i, &res);
+		now->mode_ms[i] = (uint64_t)res.ticks * 1000 / SW_TIMER_HZ;
+	}
+	now->i2c_ms = i2c_active_ms();
+	now->leuart_bytes = leuart_tx_bytes();
+	now->core_kcycles = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns how much a counter has gone up, or its value if it has been cleared.
+ *
+ ******************************************************************************/
+static uint32_t energy_delta(uint32_t now, uint32_t before){
+	if(now < before){
+		return now;
+	}
+	return now - before;
+}
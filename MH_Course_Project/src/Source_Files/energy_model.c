@@ -0,0 +1,149 @@
+/**
+ * @file energy_model.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Charge and battery life model of the board
+ *
+ * @details
+ *  Turns the time spent in each energy mode and the activity of the peripherals
+ *  into the charge drawn from the battery, using the currents of the board's
+ *  calibration table. Charge is kept in pC, which is nA times ms, so the model
+ *  only needs integer products. Nothing here touches the hardware, so the same
+ *  file is built on the host by tools/energy_replay.c to run the model over a
+ *  recorded trace.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "energy_model.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the charge drawn over a sample.
+ *
+ * @details
+ *	Each energy mode draws its MCU current for the time spent in it, and the
+ *	base current is drawn for the whole sample. The part of the EM0 current
+ *	that follows the core clock is charged per cycle run instead, since a nA
+ *	per MHz for a thousand cycles is a pC at any clock. The I2C and LEUART currents are
+ *	added on top of the mode the MCU was in while they were active.
+ *
+ * @param[in] cal
+ *   The calibration table of the board.
+ *
+ * @param[in] sample
+ *   The times and activity of the sample.
+ *
+ * @return
+ *   The charge in pC.
+ *
+ ******************************************************************************/
+uint64_t energy_model_charge_pc(const ENERGY_CALIBRATION *cal, const ENERGY_SAMPLE *sample){
+	uint64_t charge = 0;
+
+	for(uint32_t i = 0; i < ENERGY_MODES; i++){
+		charge += (uint64_t)cal->mode_na[i] * sample->mode_ms[i];
+	}
+	charge += (uint64_t)cal->em0_na_per_mhz * sample->core_kcycles;
+	charge += (uint64_t)cal->base_na * energy_model_sample_ms(sample);
+	charge += (uint64_t)cal->i2c_na * sample->i2c_ms;
+	charge += (uint64_t)cal->leuart_tx_na * sample->leuart_bytes * cal->leuart_byte_us / 1000;
+	return charge;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the length of a sample, the time spent in all the energy modes.
+ *
+ ******************************************************************************/
+uint32_t energy_model_sample_ms(const ENERGY_SAMPLE *sample){
+	uint32_t ms = 0;
+
+	for(uint32_t i = 0; i < ENERGY_MODES; i++){
+		ms += sample->mode_ms[i];
+	}
+	return ms;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the energy of a charge drawn at the supply voltage.
+ *
+ * @param[in] cal
+ *   The calibration table of the board.
+ *
+ * @param[in] charge_pc
+ *   The charge in pC.
+ *
+ * @return
+ *   The energy in uJ.
+ *
+ ******************************************************************************/
+uint32_t energy_model_uj(const ENERGY_CALIBRATION *cal, uint64_t charge_pc){
+	return charge_pc * cal->supply_mv / 1000000000;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the average current of a charge drawn over a time.
+ *
+ * @param[in] charge_pc
+ *   The charge in pC.
+ *
+ * @param[in] ms
+ *   The time the charge was drawn over.
+ *
+ * @return
+ *   The average current in nA, or 0 if no time has passed.
+ *
+ ******************************************************************************/
+uint32_t energy_model_average_na(uint64_t charge_pc, uint32_t ms){
+	if(ms == 0){
+		return 0;
+	}
+	return charge_pc / ms;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns how long the battery lasts at an average current.
+ *
+ * @param[in] cal
+ *   The calibration table of the board.
+ *
+ * @param[in] average_na
+ *   The average current in nA.
+ *
+ * @return
+ *   The battery life in hours, or UINT32_MAX if nothing is drawn.
+ *
+ ******************************************************************************/
+uint32_t energy_model_life_hours(const ENERGY_CALIBRATION *cal, uint32_t average_na){
+	uint64_t hours;
+
+	if(average_na == 0){
+		return UINT32_MAX;
+	}
+	hours = (uint64_t)cal->battery_mah * 1000000 / average_na;
+	if(hours > UINT32_MAX){
+		return UINT32_MAX;
+	}
+	return hours;
+}
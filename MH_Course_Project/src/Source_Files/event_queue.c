@@ -0,0 +1,170 @@
+/**
+ * @file event_queue.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Single producer, single consumer queues of scheduler events
+ *
+ * @details
+ *  The scheduler keeps one bit per event, so an event posted twice before it
+ *  is serviced is only serviced once. Each interrupt source owns one of these
+ *  queues, which keeps every occurrence of its events along with a 32-bit
+ *  payload. The interrupt handler is the only producer and the main loop is the
+ *  only consumer, so neither side needs a critical section.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** Standard Libraries
+
+//** Silicon Lab include files
+
+//** User/developer include files
+#include "event_queue.h"
+
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Initializes an event queue to be empty.
+ *
+ * @details
+ *	The read and write pointers are free running and only masked when an entry
+ *	is accessed, so the number of entries is always their difference.
+ *
+ * @note
+ *	Must be called before the interrupt that posts to the queue is enabled.
+ *
+ * @param[in] queue
+ *   Pointer to the queue being opened.
+ *
+ ******************************************************************************/
+void event_queue_open(EVENT_QUEUE *queue){
+	queue->write_ptr = 0;
+	queue->read_ptr = 0;
+	queue->overflow = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Adds an event and its payload to the queue and schedules the event.
+ *
+ * @details
+ *	The entry is written before the write pointer is advanced, with a memory
+ *	barrier in between, so the consumer can never see a partially written entry.
+ *	If the queue is full the entry is dropped and counted in the overflow field.
+ *
+ * @note
+ *	Only one context, normally an interrupt handler, may post to a queue.
+ *
+ * @param[in] queue
+ *   Pointer to the queue of the interrupt source.
+ *
+ * @param[in] event
+ *   The scheduler event the entry belongs to.
+ *
+ * @param[in] payload
+ *   The data that is carried with the event.
+ *
+ * @return
+ *   Returns true if the entry was added to the queue.
+ *
+ ******************************************************************************/
+bool event_queue_post(EVENT_QUEUE *queue, uint32_t event, uint32_t payload){
+	uint32_t write_ptr = queue->write_ptr;
+
+	if((write_ptr - queue->read_ptr) >= EVENT_QUEUE_SIZE){
+		queue->overflow++;
+		return false;
+	}
+	queue->entry[write_ptr & EVENT_QUEUE_MASK].event = event;
+	queue->entry[write_ptr & EVENT_QUEUE_MASK].payload = payload;
+	__DMB();
+	queue->write_ptr = write_ptr + 1;
+
+	add_scheduled_event(event);
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Removes the oldest entry from the queue if it belongs to an event.
+ *
+ * @details
+ *	Entries are removed in the order they were posted. If the oldest entry
+ *	belongs to a different event it is left in place for the handler of that
+ *	event, which was scheduled when the entry was posted. Once an entry is
+ *	removed, the event of the next entry is scheduled again, so every entry
+ *	of the queue is handed to its handler in order.
+ *
+ * @note
+ *	Only the main loop may read from a queue.
+ *
+ * @param[in] queue
+ *   Pointer to the queue of the interrupt source.
+ *
+ * @param[in] event
+ *   The scheduler event of the handler reading the queue.
+ *
+ * @param[out] payload
+ *   The payload of the removed entry.
+ *
+ * @return
+ *   Returns true if an entry of the event was removed.
+ *
+ ******************************************************************************/
+bool event_queue_get(EVENT_QUEUE *queue, uint32_t event, uint32_t *payload){
+	uint32_t read_ptr = queue->read_ptr;
+
+	if(read_ptr == queue->write_ptr){
+		return false;
+	}
+	__DMB();
+	if(queue->entry[read_ptr & EVENT_QUEUE_MASK].event != event){
+		return false;
+	}
+	*payload = queue->entry[read_ptr & EVENT_QUEUE_MASK].payload;
+	__DMB();
+	queue->read_ptr = read_ptr + 1;
+
+	event_queue_notify(queue);
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Schedules the event of the oldest entry in the queue.
+ *
+ * @details
+ *	Used after a handler leaves an entry in the queue, such as when the
+ *	resource needed to service it is busy, to have it serviced again later.
+ *
+ * @param[in] queue
+ *   Pointer to the queue of the interrupt source.
+ *
+ ******************************************************************************/
+void event_queue_notify(EVENT_QUEUE *queue){
+	uint32_t read_ptr = queue->read_ptr;
+
+	if(read_ptr != queue->write_ptr){
+		__DMB();
+		add_scheduled_event(queue->entry[read_ptr & EVENT_QUEUE_MASK].event);
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of entries waiting in the queue.
+ *
+ * @param[in] queue
+ *   Pointer to the queue of the interrupt source.
+ *
+ ******************************************************************************/
+uint32_t event_queue_count(EVENT_QUEUE *queue){
+	return queue->write_ptr - queue->read_ptr;
+}
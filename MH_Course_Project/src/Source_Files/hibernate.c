@@ -0,0 +1,163 @@
+/**
+ * @file hibernate.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief EM4 hibernate between readings, woken by the CRYOTIMER
+ *
+ * @details
+ *  For long sampling periods the device is put in EM4H between readings instead
+ *  of waiting in EM3 for the LETIMER. The CRYOTIMER runs from the ULFRCO through
+ *  EM4H and wakes the device every HIBERNATE_PERIOD. Waking from EM4 is a reset,
+ *  so the little state the application needs is kept in the RTCC retention
+ *  registers, which are powered in EM4H.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "hibernate.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static bool woke;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Returns whether this reset is a wakeup from hibernation.
+ *
+ * @details
+ *	The reset must be an EM4 wakeup and the retention registers must have been
+ *	marked valid by hibernate_enter(), so any other reset is a cold boot.
+ *
+ * @note
+ *	Must be called before watchdog_open(), which clears the reset cause.
+ *
+ ******************************************************************************/
+bool hibernate_woke(void){
+	CMU_ClockEnable(cmuClock_CORELE, true);
+	CMU_ClockEnable(cmuClock_RTCC, true);
+
+	woke = (RMU_ResetCauseGet() & RMU_RSTCAUSE_EM4RST) &&
+			RTCC->RET[HIBERNATE_RET_MAGIC].REG == HIBERNATE_MAGIC;
+	return woke;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Loads the state saved by hibernate_enter() before the last hibernation.
+ *
+ * @param[out] state
+ *   Pointer to the struct the state is copied to.
+ *
+ ******************************************************************************/
+void hibernate_load(HIBERNATE_STATE *state){
+	EFM_ASSERT(woke);
+
+	state->flags = RTCC->RET[HIBERNATE_RET_FLAGS].REG;
+	state->wakes = RTCC->RET[HIBERNATE_RET_WAKES].REG;
+	state->awake_ms = RTCC->RET[HIBERNATE_RET_AWAKE].REG;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the time since the CRYOTIMER woke the device.
+ *
+ * @details
+ *	The CRYOTIMER keeps counting through the wakeup reset and the period flag is
+ *	set as its count passes each multiple of HIBERNATE_PERIOD_TICKS, so the count
+ *	past the last multiple is the time since the wakeup, including the reset and
+ *	every step of the reinitialisation.
+ *
+ * @return
+ *   Milliseconds since the wakeup, or 0 after a cold boot.
+ *
+ ******************************************************************************/
+uint32_t hibernate_ms_since_wake(void){
+	if(!woke){
+		return 0;
+	}
+	CMU_ClockEnable(cmuClock_CRYOTIMER, true);
+	return CRYOTIMER_CounterGet() & (HIBERNATE_PERIOD_TICKS - 1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Marks the retention registers as invalid, so the next reset is a cold boot.
+ *
+ ******************************************************************************/
+void hibernate_clear(void){
+	CMU_ClockEnable(cmuClock_CORELE, true);
+	CMU_ClockEnable(cmuClock_RTCC, true);
+
+	RTCC->RET[HIBERNATE_RET_MAGIC].REG = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Saves the state and enters EM4H until the next CRYOTIMER period.
+ *
+ * @details
+ *	The time spent awake since the wakeup is saved with the state. The CRYOTIMER
+ *	is only started the first time, so later wakeups stay on the same period no
+ *	matter how long each one was awake. The ULFRCO is kept running in EM4H for
+ *	the CRYOTIMER, and the GPIO are latched so the Si7021 stays powered and the
+ *	LEUART line stays idle until the application has reconfigured them and
+ *	called EMU_UnlatchPinRetention().
+ *
+ * @note
+ *	Never returns. The caller must stop the watchdog and anything still running
+ *	that should not wake the device.
+ *
+ * @param[in] state
+ *   Pointer to the state to keep through EM4H, its awake_ms is updated.
+ *
+ ******************************************************************************/
+void hibernate_enter(HIBERNATE_STATE *state){
+	EMU_EM4Init_TypeDef em4_init = EMU_EM4INIT_DEFAULT;
+	CRYOTIMER_Init_TypeDef cryo_init = CRYOTIMER_INIT_DEFAULT;
+
+	state->awake_ms = hibernate_ms_since_wake();
+
+	CMU_ClockEnable(cmuClock_CORELE, true);
+	CMU_ClockEnable(cmuClock_RTCC, true);
+	RTCC->RET[HIBERNATE_RET_FLAGS].REG = state->flags;
+	RTCC->RET[HIBERNATE_RET_WAKES].REG = state->wakes;
+	RTCC->RET[HIBERNATE_RET_AWAKE].REG = state->awake_ms;
+	RTCC->RET[HIBERNATE_RET_MAGIC].REG = HIBERNATE_MAGIC;
+
+	CMU_ClockEnable(cmuClock_CRYOTIMER, true);
+	if(!woke){
+		cryo_init.enable = true;
+		cryo_init.debugRun = false;
+		cryo_init.em4Wakeup = true;
+		cryo_init.osc = cryotimerOscULFRCO;
+		cryo_init.presc = cryotimerPresc_1;
+		cryo_init.period = HIBERNATE_PERIOD;
+		CRYOTIMER_Init(&cryo_init);
+	}
+	CRYOTIMER_EM4WakeupEnable(true);
+	CRYOTIMER_IntClear(CRYOTIMER_IF_PERIOD);
+
+	em4_init.em4State = emuEM4Hibernate;
+	em4_init.retainLfxo = false;
+	em4_init.retainLfrco = false;
+	em4_init.retainUlfrco = true;
+	em4_init.pinRetentionMode = emuPinRetentionLatch;
+	EMU_EM4Init(&em4_init);
+
+	EMU_EnterEM4H();
+	EFM_ASSERT(false);
+}
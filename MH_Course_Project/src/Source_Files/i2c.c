@@ -13,6 +13,7 @@
 
 //** User/developer include files
 #include "i2c.h"
+#include "trace.h"
 
 
 //***********************************************************************************
@@ -21,6 +22,18 @@
 
 static I2C_STATE_MACHINE i2c_sm;
 static uint32_t	event;
+static EVENT_QUEUE i2c_queue;
+static SLEEP_OWNER i2c_sleep_owner;
+static SLEEP_HOOK i2c_sleep_hook;
+static CMU_Clock_TypeDef i2c_clock;
+static uint32_t active_since;
+static uint32_t active_ticks;
+static PERF_CLIENT i2c_perf_client;
+static PERF_NOTIFY i2c_perf_notify;
+static I2C_TypeDef *bus_i2c;
+static uint32_t bus_freq;
+static I2C_ClockHLR_TypeDef bus_clhr;
+static uint32_t bus_core_hz;
 
 //***********************************************************************************
 // Private functions
@@ -30,6 +43,84 @@ static void i2c_nack(void);
 static void i2c_rxdatav(void);
 static void i2c_mstop(void);
 static void i2c_bus_reset(I2C_TypeDef *i2c);
+static void i2c_suspend(uint32_t EM);
+static void i2c_resume(uint32_t EM);
+static uint32_t i2c_min_core_hz(uint32_t freq, I2C_ClockHLR_TypeDef clhr);
+static void i2c_clock_changed(uint32_t core_hz);
+/***************************************************************************//**
+ * @brief
+ *	Gates the I2C clock before the core sleeps in EM2 or EM3.
+ *
+ * @details
+ *	I2C_EM_BLOCK keeps the core out of EM2 while a transaction is in progress,
+ *	so the peripheral is always idle here. Its registers are kept while the
+ *	clock is gated.
+ *
+ * @param[in] EM
+ *   The energy mode being entered.
+ *
+ ******************************************************************************/
+static void i2c_suspend(uint32_t EM){
+	EFM_ASSERT(!i2c_sm.busy);
+	CMU_ClockEnable(i2c_clock, false);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Ungates the I2C clock once the core has woken up.
+ *
+ * @param[in] EM
+ *   The energy mode that was entered.
+ *
+ ******************************************************************************/
+static void i2c_resume(uint32_t EM){
+	CMU_ClockEnable(i2c_clock, true);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the slowest core clock that can run the bus at its frequency.
+ *
+ * @details
+ *	The I2C clock is HFPER / ((Nlow + Nhigh) * (DIV + 1) + 8), so the bus only
+ *	reaches its frequency with DIV at 0 if HFPER, which runs at the core clock,
+ *	is at least freq * (Nlow + Nhigh + 8).
+ *
+ ******************************************************************************/
+static uint32_t i2c_min_core_hz(uint32_t freq, I2C_ClockHLR_TypeDef clhr){
+	uint32_t n;
+
+	switch(clhr){
+	case i2cClockHLRAsymetric:
+		n = 6 + 3;
+		break;
+	case i2cClockHLRFast:
+		n = 11 + 6;
+		break;
+	default:
+		n = 4 + 4;
+		break;
+	}
+	return freq * (n + 8);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets the bus divider again after the core clock has changed.
+ *
+ * @details
+ *	A transaction holds its request until the MSTOP interrupt, so the clock can
+ *	only be lowered while the bus is idle. Another client can still raise it
+ *	during a transaction, which then runs at the new divider from the next byte.
+ *
+ * @param[in] core_hz
+ *   The new core clock frequency.
+ *
+ ******************************************************************************/
+static void i2c_clock_changed(uint32_t core_hz){
+	I2C_BusFreqSet(bus_i2c, 0, bus_freq, bus_clhr);
+}
+
 /***************************************************************************//**
  * @brief
  *	This function resets the I2C bus for either the I2C0 or I2C1 peripheral
@@ -267,9 +358,12 @@ static void i2c_mstop(){
 		break;
 		}
 		case end_comm:{
-			sleep_unblock_mode(I2C_EM_BLOCK);
-			add_scheduled_event(event);
+			sleep_unblock_mode(&i2c_sleep_owner, I2C_EM_BLOCK);
+			perf_release(&i2c_perf_client);
+			active_ticks += sw_timer_now() - active_since;
 			i2c_sm.state = handshake;
+			i2c_sm.busy = false;
+			event_queue_post(&i2c_queue, event, *i2c_sm.data);
 		break;
 		}
 		default:{
@@ -307,15 +401,19 @@ static void i2c_mstop(){
  *
  ******************************************************************************/
 void i2c_open(I2C_TypeDef *i2c, I2C_OPEN_STRUCT *i2c_setup){
+	sleep_owner_register(&i2c_sleep_owner, "i2c", I2C_MAX_HOLD_MS);
+
 	if(i2c == I2C0){
-		CMU_ClockEnable(cmuClock_I2C0, true);
+		i2c_clock = cmuClock_I2C0;
 		NVIC_EnableIRQ(I2C0_IRQn);
 	} else if(i2c == I2C1){
-		CMU_ClockEnable(cmuClock_I2C1, true);
+		i2c_clock = cmuClock_I2C1;
 		NVIC_EnableIRQ(I2C1_IRQn);
 	} else {
-		CMU_ClockEnable(cmuClock_I2C0, true);
+		i2c_clock = cmuClock_I2C0;
 	}
+	CMU_ClockEnable(i2c_clock, true);
+	sleep_hook_register(&i2c_sleep_hook, i2c_suspend, i2c_resume, EM2, SLEEP_HOOK_I2C);
 
 	if ((i2c->IF & 0x01) == 0){
 		i2c->IFS = 0x01;
@@ -333,7 +431,16 @@ void i2c_open(I2C_TypeDef *i2c, I2C_OPEN_STRUCT *i2c_setup){
 	i2c_init_struct.freq = i2c_setup->freq;
 	i2c_init_struct.refFreq = i2c_setup->refFreq;
 	event = i2c_setup->event_def;
+	event_queue_open(&i2c_queue);
+	i2c_sm.busy = false;
+	active_ticks = 0;
 	I2C_Init(i2c, &i2c_init_struct);
+	bus_i2c = i2c;
+	bus_freq = i2c_setup->freq;
+	bus_clhr = i2c_setup->clhr;
+	bus_core_hz = i2c_min_core_hz(bus_freq, bus_clhr);
+	perf_client_register(&i2c_perf_client, "i2c");
+	perf_notify_register(&i2c_perf_notify, i2c_clock_changed);
 	i2c->ROUTELOC0 = i2c_setup->scl_loc | i2c_setup->sda_loc;
 	i2c->ROUTEPEN = (i2c_setup->scl_en * _I2C_ROUTEPEN_SCLPEN_MASK) |
 			(i2c_setup->sda_en * _I2C_ROUTEPEN_SDAPEN_MASK);
@@ -355,12 +462,13 @@ void i2c_open(I2C_TypeDef *i2c, I2C_OPEN_STRUCT *i2c_setup){
  * @details
  *	Begins by ensuring that the I2C state machine is not busy with another operation,
  *	and upon confirmation of availability, blocks the appropriate energy mode,
- *	and then begins the state machine with the values passed through the function
- *	call.
+ *	requests a core clock fast enough for the bus frequency, and then begins the
+ *	state machine with the values passed through the function call.
  *
  * @note
  *	Requires that the I2C bus in not in use when called or this function will be
- *	caught in an EFM_ASSERT.
+ *	caught in an EFM_ASSERT. The read data is cleared since the received bytes
+ *	are or'ed into it.
  *
  * @param[in] slave_add
  *   Pointer to the base peripheral address of the i2c slave device.
@@ -385,21 +493,64 @@ void i2c_start(uint32_t slave_add, uint32_t cmd,  uint32_t *read_data, I2C_TypeD
 //	Check that the state machine is available
 	EFM_ASSERT((i2c->STATE & _I2C_STATE_MASK) == I2C_STATE_STATE_IDLE);
 
-	sleep_block_mode(I2C_EM_BLOCK);
+	sleep_block_mode(&i2c_sleep_owner, I2C_EM_BLOCK);
+	perf_request(&i2c_perf_client, bus_core_hz);
 
 	i2c_sm.state = handshake;
 	i2c_sm.slave_address = slave_add;
 	i2c_sm.command = cmd;
 	i2c_sm.data = read_data;
+	*i2c_sm.data = 0;
 	i2c_sm.read = false;
+	i2c_sm.busy = true;
 	i2c_sm.I2Cn = i2c;
 	i2c_sm.callback = si7021_read_cb;
+	active_since = sw_timer_now();
 
+	trace_record(TRACE_I2C_START, slave_add);
 	i2c->CMD = I2C_CMD_START;
 	i2c->TXDATA = (slave_add << 1) | false;
 
 }
 
+/***************************************************************************//**
+ * @brief
+ *	Returns whether the I2C state machine is in the middle of a transaction.
+ *
+ * @details
+ *	The state machine is busy from i2c_start() until the MSTOP interrupt of the
+ *	transaction has been serviced.
+ *
+ ******************************************************************************/
+bool i2c_busy(void){
+	return i2c_sm.busy;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the total time the bus has spent in transactions since i2c_open().
+ *
+ * @details
+ *	A transaction is timed from i2c_start() until its MSTOP interrupt, so the
+ *	time includes the Si7021 measurement that the reads wait through.
+ *
+ ******************************************************************************/
+uint32_t i2c_active_ms(void){
+	return (uint64_t)active_ticks * 1000 / SW_TIMER_HZ;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the queue that the I2C interrupt handler posts its events to.
+ *
+ * @details
+ *	The completion event of each transaction carries the data that was read.
+ *
+ ******************************************************************************/
+EVENT_QUEUE *i2c_event_queue(void){
+	return &i2c_queue;
+}
+
 /***************************************************************************//**
  * @brief
  * 	This function is the interrupt handler for the I2C peripheral.
@@ -432,4 +583,5 @@ void I2C0_IRQHandler(void){
 	if(int_flag & I2C_IF_MSTOP){
 		i2c_mstop();
 	}
+	trace_record(TRACE_I2C_STATE, i2c_sm.state);
 }
@@ -25,6 +25,9 @@
 static uint32_t scheduled_comp0_cb;
 static uint32_t scheduled_comp1_cb;
 static uint32_t scheduled_uf_cb;
+static uint32_t uf_count;
+static EVENT_QUEUE letimer_queue;
+static SLEEP_OWNER letimer_sleep_owner;
 
 //***********************************************************************************
 // Global functions
@@ -65,6 +68,7 @@ void letimer_pwm_open(LETIMER_TypeDef *letimer, APP_LETIMER_PWM_TypeDef *app_let
 	if(letimer == LETIMER0){
 		CMU_ClockEnable(cmuClock_LETIMER0, true);
 	}
+	sleep_owner_register(&letimer_sleep_owner, "letimer", SLEEP_HOLD_UNLIMITED);
 	letimer_start(letimer,false);
 	letimer->IFC = LETIMER_IFC_COMP0 | LETIMER_IFC_COMP1 | LETIMER_IFC_UF;
 
@@ -81,6 +85,8 @@ void letimer_pwm_open(LETIMER_TypeDef *letimer, APP_LETIMER_PWM_TypeDef *app_let
 	scheduled_comp0_cb = app_letimer_struct->comp0_cb;
 	scheduled_comp1_cb = app_letimer_struct->comp1_cb;
 	scheduled_uf_cb = app_letimer_struct->uf_cb;
+	uf_count = 0;
+	event_queue_open(&letimer_queue);
 	/* Use EFM_ASSERT statements to verify whether the LETIMER clock tree is properly
 	 * configured and enabled
 	 * You must select a register that utilizes the clock enabled to be tested
@@ -145,8 +151,8 @@ void letimer_pwm_open(LETIMER_TypeDef *letimer, APP_LETIMER_PWM_TypeDef *app_let
 	}
 
 	/* Check if LETIEMR has been enabled, and enable energy mode blocking*/
-	if(LETIMER_STATUS_RUNNING == 1){
-		sleep_block_mode(LETIMER_EM);
+	if(letimer->STATUS & LETIMER_STATUS_RUNNING){
+		sleep_block_mode(&letimer_sleep_owner, LETIMER_EM);
 	}
 
 
@@ -173,14 +179,16 @@ void letimer_pwm_open(LETIMER_TypeDef *letimer, APP_LETIMER_PWM_TypeDef *app_let
  *
  ******************************************************************************/
 void letimer_start(LETIMER_TypeDef *letimer, bool enable){
-	if(LETIMER_STATUS_RUNNING == 0 && enable){
-		sleep_block_mode(LETIMER_EM);
+	bool running = letimer->STATUS & LETIMER_STATUS_RUNNING;
+
+	if(!running && enable){
+		sleep_block_mode(&letimer_sleep_owner, LETIMER_EM);
 	}
-	if(LETIMER_STATUS_RUNNING == 1 && !enable){
-		sleep_unblock_mode(LETIMER_EM);
+	if(running && !enable){
+		sleep_unblock_mode(&letimer_sleep_owner, LETIMER_EM);
 	}
 	LETIMER_Enable(letimer, enable);
-	if(LETIMER_STATUS_RUNNING != enable){
+	if(running != enable){
 		while(letimer->SYNCBUSY);
 	}
 
@@ -192,10 +200,10 @@ void letimer_start(LETIMER_TypeDef *letimer, bool enable){
  *
  * @details
  * 	This function first removes the interrupt bit from the IFC register, and then handles
- * 	the cause of the interrupt. For comp0 and comp1 interrupts, the event is just added to
- * 	the scheduler, but for the underflow interrupt, it adds the event to the scheduler
- * 	and advances the energy mode forward so that the processor loops through the different
- * 	energy modes.
+ * 	the cause of the interrupt. Each interrupt is posted to the LETIMER event queue, which
+ * 	also adds the event to the scheduler. The comp0 and comp1 events carry the counter value
+ * 	and the underflow event carries the number of underflows since the LETIMER was opened,
+ * 	so the application can tell that no period was missed.
  *
  * @note
  *	This function is mainly called off of the underflow interrupt, which occurs once
@@ -207,23 +215,110 @@ void LETIMER0_IRQHandler(void){
 	int_flag = LETIMER0->IF & LETIMER0->IEN;
 	LETIMER0->IFC = int_flag;
 	if(int_flag & LETIMER_IF_COMP0){
-		add_scheduled_event(scheduled_comp0_cb);
+		event_queue_post(&letimer_queue, scheduled_comp0_cb, LETIMER0->CNT);
 		EFM_ASSERT(!(LETIMER0->IF & LETIMER_IF_COMP0));
 	}
 	if(int_flag & LETIMER_IF_COMP1){
-		add_scheduled_event(scheduled_comp1_cb);
+		event_queue_post(&letimer_queue, scheduled_comp1_cb, LETIMER0->CNT);
 		EFM_ASSERT(!(LETIMER0->IF & LETIMER_IF_COMP1));
 	}
 	if(int_flag & LETIMER_IF_UF){
-		add_scheduled_event(scheduled_uf_cb);
-//		uint32_t current;
-//		current = current_block_energy_mode();
-//		sleep_unblock_mode(current);
-//		if(current < 4){
-//			sleep_block_mode(current + 1);
-//		} else {
-//			sleep_block_mode(EM0);
-//		}
+		event_queue_post(&letimer_queue, scheduled_uf_cb, uf_count++);
 		EFM_ASSERT(!(LETIMER0->IF & LETIMER_IF_UF));
 	}
 }
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the time until the next underflow of a LETIMER.
+ *
+ * @details
+ *	The LETIMER counts down from COMP0 to the underflow, so the counter value
+ *	is the number of LETIMER_HZ ticks until the next underflow interrupt.
+ *
+ * @param[in] letimer
+ *	Pointer to the base peripheral address of the LETIMER peripheral.
+ *
+ * @return
+ *	Milliseconds until the next underflow, or LETIMER_IDLE if the LETIMER is
+ *	stopped.
+ *
+ ******************************************************************************/
+uint32_t letimer_ms_to_underflow(LETIMER_TypeDef *letimer){
+	if(!(letimer->STATUS & LETIMER_STATUS_RUNNING)){
+		return LETIMER_IDLE;
+	}
+	return letimer->CNT * 1000 / LETIMER_HZ;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the queue that the LETIMER0 interrupt handler posts its events to.
+ *
+ ******************************************************************************/
+EVENT_QUEUE *letimer_event_queue(void){
+	return &letimer_queue;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Stress test of the LETIMER0 event queue.
+ *
+ * @details
+ *	The underflow interrupt is fired back to back through the IFS register, so
+ *	the real interrupt handler posts to the queue. Each round first fills the
+ *	queue completely and empties it, and then fires one interrupt before every
+ *	read so the interrupt handler and the reader run interleaved. The underflow
+ *	count carried by every entry must be one more than the previous entry, which
+ *	proves that no event was dropped or merged.
+ *
+ * @note
+ *	The LETIMER is stopped during the test so a real underflow does not add an
+ *	entry, and it is restarted afterwards if it was running. The underflow event
+ *	is removed from the scheduler once the queue has been emptied.
+ *
+ ******************************************************************************/
+void letimer_event_queue_test(void){
+	uint32_t payload;
+	uint32_t expected;
+	uint32_t save_IEN;
+	bool running;
+
+	running = LETIMER0->STATUS & LETIMER_STATUS_RUNNING;
+	LETIMER_Enable(LETIMER0, false);
+	while(LETIMER0->SYNCBUSY);
+	save_IEN = LETIMER0->IEN;
+	LETIMER0->IEN = LETIMER_IEN_UF;
+
+	expected = uf_count;
+	for(uint32_t round = 0; round < EVENT_QUEUE_TEST_ROUNDS; round++){
+		// Fill the queue with interrupts fired back to back
+		for(uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++){
+			LETIMER0->IFS = LETIMER_IFS_UF;
+			while(LETIMER0->IF & LETIMER_IF_UF);
+		}
+		EFM_ASSERT(event_queue_count(&letimer_queue) == EVENT_QUEUE_SIZE);
+		for(uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++){
+			EFM_ASSERT(event_queue_get(&letimer_queue, scheduled_uf_cb, &payload));
+			EFM_ASSERT(payload == expected);
+			expected++;
+		}
+		EFM_ASSERT(event_queue_count(&letimer_queue) == 0);
+
+		// Interleave the interrupt handler with the reader
+		for(uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++){
+			LETIMER0->IFS = LETIMER_IFS_UF;
+			while(LETIMER0->IF & LETIMER_IF_UF);
+			EFM_ASSERT(event_queue_get(&letimer_queue, scheduled_uf_cb, &payload));
+			EFM_ASSERT(payload == expected);
+			expected++;
+		}
+	}
+	EFM_ASSERT(letimer_queue.overflow == 0);
+	EFM_ASSERT(uf_count == expected);
+	remove_scheduled_event(scheduled_uf_cb);
+
+	LETIMER0->IEN = save_IEN;
+	LETIMER_Enable(LETIMER0, running);
+	while(LETIMER0->SYNCBUSY);
+}
@@ -29,6 +29,7 @@
 //** Developer/user include files
 #include "leuart.h"
 #include "scheduler.h"
+#include "trace.h"
 
 //***********************************************************************************
 // private variables
@@ -38,6 +39,11 @@ static uint32_t	leuart0_tx_done_cb;
 //static bool		leuart0_tx_busy;
 static TX_LEUART_STATE_MACHINE tx_leuart_sm;
 static RX_LEUART_STATE_MACHINE rx_leuart_sm;
+static EVENT_QUEUE leuart_queue;
+static SLEEP_OWNER leuart_tx_sleep_owner;
+static SLEEP_HOOK leuart_sleep_hook;
+static DCDC_CLIENT leuart_tx_dcdc_client;
+static uint32_t tx_bytes;
 
 //***********************************************************************************
 // Private functions
@@ -47,6 +53,8 @@ static void leuart_txc(void);
 static void leuart_startf(void);
 static void leuart_rxdatav(void);
 static void leuart_sigf(void);
+static void leuart_suspend(uint32_t EM);
+static void leuart_resume(uint32_t EM);
 
 /***************************************************************************//**
  * @brief
@@ -118,8 +126,11 @@ static void leuart_txc(void){
 			tx_leuart_sm.LEUARTn->IEN &= ~LEUART_IEN_TXC;
 			tx_leuart_sm.busy = false;
 			tx_leuart_sm.state = stop;
-			add_scheduled_event(tx_leuart_sm.callback);
-			sleep_unblock_mode(LEUART_TX_EM);
+			trace_record(TRACE_LEUART_TX_DONE, tx_leuart_sm.sent_bytes);
+			tx_bytes += tx_leuart_sm.sent_bytes;
+			event_queue_post(&leuart_queue, tx_leuart_sm.callback, tx_leuart_sm.sent_bytes);
+			sleep_unblock_mode(&leuart_tx_sleep_owner, LEUART_TX_EM);
+			dcdc_release(&leuart_tx_dcdc_client);
 		break;
 		}
 		default:{
@@ -237,7 +248,8 @@ static void leuart_sigf(void){
 			rx_leuart_sm.str[rx_leuart_sm.str_len] = '\0';
 			rx_leuart_sm.str_len++;
 			rx_leuart_sm.state = RXstart;
-			add_scheduled_event(leuart_rx_cb);
+			trace_record(TRACE_LEUART_RX, rx_leuart_sm.str_len);
+			event_queue_post(&leuart_queue, leuart_rx_cb, rx_leuart_sm.str_len);
 		break;
 		}
 		case decode:{
@@ -254,6 +266,36 @@ static void leuart_sigf(void){
 
 
 
+/***************************************************************************//**
+ * @brief
+ *	Gates the LEUART0 clock before the core sleeps in EM3.
+ *
+ * @details
+ *	The LFXO that clocks the LEUART stops in EM3, so nothing can be sent or
+ *	received, and LEUART_TX_EM keeps the core out of EM3 while a transmit is in
+ *	progress. The registers are kept while the clock is gated.
+ *
+ * @param[in] EM
+ *   The energy mode being entered.
+ *
+ ******************************************************************************/
+static void leuart_suspend(uint32_t EM){
+	EFM_ASSERT(!tx_leuart_sm.busy);
+	CMU_ClockEnable(cmuClock_LEUART0, false);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Ungates the LEUART0 clock once the core has woken up.
+ *
+ * @param[in] EM
+ *   The energy mode that was entered.
+ *
+ ******************************************************************************/
+static void leuart_resume(uint32_t EM){
+	CMU_ClockEnable(cmuClock_LEUART0, true);
+}
+
 //***********************************************************************************
 // Global functions
 //***********************************************************************************
@@ -278,9 +320,14 @@ static void leuart_sigf(void){
  ******************************************************************************/
 
 void leuart_open(LEUART_TypeDef *leuart, LEUART_OPEN_STRUCT *leuart_settings){
+	sleep_owner_register(&leuart_tx_sleep_owner, "leuart_tx", LEUART_TX_MAX_HOLD_MS);
+	dcdc_client_register(&leuart_tx_dcdc_client, "leuart_tx");
+
 	if(leuart == LEUART0){
 		CMU_ClockEnable(cmuClock_LEUART0, true);
 		NVIC_EnableIRQ(LEUART0_IRQn);
+		sleep_hook_register(&leuart_sleep_hook, leuart_suspend, leuart_resume, EM3, SLEEP_HOOK_LEUART);
+		tx_bytes = 0;
 	} else {
 		//impossible
 		EFM_ASSERT(false);
@@ -304,6 +351,7 @@ void leuart_open(LEUART_TypeDef *leuart, LEUART_OPEN_STRUCT *leuart_settings){
 	leuart_init_struct.stopbits = leuart_settings->stopbits;
 	leuart0_tx_done_cb = leuart_settings->tx_done_evt;
 	leuart_rx_cb = leuart_settings->rx_done_evt;
+	event_queue_open(&leuart_queue);
 	LEUART_Init(leuart, &leuart_init_struct);
 
 	leuart->ROUTELOC0 = leuart_settings->rx_loc | leuart_settings->tx_loc;
@@ -371,6 +419,8 @@ void LEUART0_IRQHandler(void){
  * @details
  * 	Transmits the string input over LEUART and once the transmit is completed,
  * 	raises the tx_done_event. This function also starts the LEUART state machine.
+ * 	The DC-DC is held in low noise until the last byte has been sent, since the
+ * 	BLE module is powered from the same supply.
  *
  * @param[in] *leuart
  * 	The pointer to the LEUART peripheral
@@ -381,17 +431,43 @@ void LEUART0_IRQHandler(void){
  ******************************************************************************/
 
 void leuart_start(LEUART_TypeDef *leuart, char *string){
-//	sleep_block_mode(EM3);
+	leuart_start_len(leuart, string, strlen(string));
+}
+
+/***************************************************************************//**
+ * @brief Begins the LEUART TX state machine with a buffer of known length.
+ *
+ * @details
+ * 	Works the same as leuart_start(), but the length is given instead of being
+ * 	found from a NULL character, so binary data containing 0 bytes can be sent.
+ * 	The DC-DC vote is made outside the critical section, so the converter has
+ * 	changed its conduction mode before the first byte goes out.
+ *
+ * @param[in] *leuart
+ * 	The pointer to the LEUART peripheral
+ *
+ * @param[in] *data
+ * 	The bytes to be transmitted, copied before the transmission starts
+ *
+ * @param[in] len
+ * 	The number of bytes to transmit, at most the size of the TX buffer
+ *
+ ******************************************************************************/
+
+void leuart_start_len(LEUART_TypeDef *leuart, const char *data, uint32_t len){
+	EFM_ASSERT(len > 0 && len <= sizeof(tx_leuart_sm.str));
 	while(leuart_busy());
+	dcdc_vote(&leuart_tx_dcdc_client, DCDC_LOW_NOISE);
 
 	CORE_DECLARE_IRQ_STATE;
 	CORE_ENTER_CRITICAL();
 
-	tx_leuart_sm.str_len = strlen(string);
+	tx_leuart_sm.str_len = len;
 	tx_leuart_sm.sent_bytes = 0;
-	strcpy(tx_leuart_sm.str, string);
+	memcpy(tx_leuart_sm.str, data, len);
 	tx_leuart_sm.busy = true;
-	sleep_block_mode(LEUART_TX_EM);
+	trace_record(TRACE_LEUART_TX, len);
+	sleep_block_mode(&leuart_tx_sleep_owner, LEUART_TX_EM);
 
 	tx_leuart_sm.state = TXdata;
 	tx_leuart_sm.LEUARTn = leuart;
@@ -417,6 +493,18 @@ bool leuart_busy(void){
 	return tx_leuart_sm.busy;
 }
 
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of bytes sent since leuart_open().
+ *
+ * @details
+ *	A transmit is counted once its TXC interrupt has been serviced.
+ *
+ ******************************************************************************/
+uint32_t leuart_tx_bytes(void){
+	return tx_bytes;
+}
+
 /***************************************************************************//**
  * @brief
  *   LEUART STATUS function returns the STATUS of the peripheral for the
@@ -628,15 +716,24 @@ void leuart_rx_test(void){
 	char str[] = "abc#Hello!def";
 //	char str[11] = "#Hello!def";
 	char rx_str[] = "#Hello!";
+	uint32_t rx_len;
 	leuart_start(leuart, str);
 	while(leuart->SYNCBUSY & LEUART_SYNCBUSY_TXDATA);
 	// wait 30ms for transmission and reception
 	timer_delay(30);
 	// should receive "#Hello!" (rx_str)
 	EFM_ASSERT(strcmp(rx_leuart_sm.str, rx_str) == 0);
+	// the RX event should carry the length of the string with its NULL character
+	EFM_ASSERT(event_queue_count(&leuart_queue) == 2);
+	if(!event_queue_get(&leuart_queue, leuart_rx_cb, &rx_len)){
+		EFM_ASSERT(event_queue_get(&leuart_queue, leuart0_tx_done_cb, &rx_len));
+		EFM_ASSERT(event_queue_get(&leuart_queue, leuart_rx_cb, &rx_len));
+	}
+	EFM_ASSERT(rx_len == strlen(rx_str) + 1);
 // Disable loop back mode
 	leuart->CTRL &= ~LEUART_CTRL_LOOPBK;
 	while(leuart->SYNCBUSY);
+	event_queue_open(&leuart_queue);
 	remove_scheduled_event(leuart_rx_cb);
 }
 /***************************************************************************//**
@@ -658,3 +755,16 @@ void leuart_rx_test(void){
 char* rx_str(void){
 	return rx_leuart_sm.str;
 }
+
+/***************************************************************************//**
+ * @brief
+ *   Returns the queue that the LEUART interrupt handler posts its events to.
+ *
+ * @details
+ * 	 The TX done event carries the number of bytes sent, and the RX done event
+ * 	 carries the length of the received string including its NULL character.
+ *
+ ******************************************************************************/
+EVENT_QUEUE *leuart_event_queue(void){
+	return &leuart_queue;
+}
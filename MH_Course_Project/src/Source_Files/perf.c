@@ -0,0 +1,319 @@
+/**
+ * @file perf.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Performance levels, the HFRCO band and EM0/EM1 voltage scaling
+ *
+ * @details
+ *  The work done on each wakeup is small, so the core runs from the lowest
+ *  HFRCO band unless a client has asked for a faster one for a span of work.
+ *  The band is the lowest one that satisfies every outstanding request, and
+ *  the EM0/EM1 voltage is scaled to match it, up before the band is raised and
+ *  down after it is lowered. Drivers that derive a divider from a high
+ *  frequency clock register a listener, which is called after every change.
+ *
+ *  The LETIMER, LEUART and RTCC run from the low frequency clocks, so their
+ *  timing does not depend on the band.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "perf.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static const CMU_HFRCOFreq_TypeDef perf_bands[] = {
+	cmuHFRCOFreq_1M0Hz,
+	cmuHFRCOFreq_2M0Hz,
+	cmuHFRCOFreq_4M0Hz,
+	cmuHFRCOFreq_7M0Hz,
+	cmuHFRCOFreq_13M0Hz,
+	cmuHFRCOFreq_16M0Hz,
+	cmuHFRCOFreq_19M0Hz,
+	cmuHFRCOFreq_26M0Hz,
+	cmuHFRCOFreq_32M0Hz,
+};
+
+static PERF_CLIENT *client_head;
+static PERF_CLIENT *client_tail;
+static PERF_NOTIFY *notify_head;
+static PERF_NOTIFY *notify_tail;
+static uint32_t core_hz;
+static uint32_t changes;
+static volatile bool release_pending;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+static uint32_t perf_band_hz(uint32_t min_hz);
+static void perf_set(uint32_t hz);
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the lowest band that runs at min_hz or faster.
+ *
+ * @details
+ *	A request above PERF_MAX_HZ gets the fastest band. With PERF_FIXED_ENABLED
+ *	every request gets PERF_MAX_HZ, for comparing the energy of a cycle against
+ *	the fixed frequency build.
+ *
+ ******************************************************************************/
+static uint32_t perf_band_hz(uint32_t min_hz){
+#ifdef PERF_FIXED_ENABLED
+	return PERF_MAX_HZ;
+#else
+	for(uint32_t i = 0; i < sizeof(perf_bands) / sizeof(perf_bands[0]); i++){
+		if((uint32_t)perf_bands[i] >= min_hz){
+			return perf_bands[i];
+		}
+	}
+	return PERF_MAX_HZ;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Moves the core to a band and tells every listener.
+ *
+ * @details
+ *	The voltage is raised before the band so the core is never clocked faster
+ *	than the voltage allows, and lowered after it. CMU_HFRCOBandSet() sets the
+ *	flash wait states for the new band.
+ *
+ * @param[in] hz
+ *   The band, one of perf_bands.
+ *
+ ******************************************************************************/
+static void perf_set(uint32_t hz){
+	if(hz == core_hz){
+		return;
+	}
+	if(hz > core_hz){
+		EMU_VScaleEM01ByClock(hz, true);
+		CMU_HFRCOBandSet((CMU_HFRCOFreq_TypeDef)hz);
+	} else {
+		CMU_HFRCOBandSet((CMU_HFRCOFreq_TypeDef)hz);
+		EMU_VScaleEM01ByClock(0, true);
+	}
+	core_hz = hz;
+	changes++;
+	trace_record(TRACE_PERF, hz / 1000);
+	for(PERF_NOTIFY *n = notify_head; n != NULL; n = n->next){
+		n->fn(hz);
+	}
+}
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Opens the performance levels and drops the core to the lowest band.
+ *
+ * @details
+ *	The low power EM0/EM1 voltage is enabled so EMU_VScaleEM01ByClock() can use
+ *	it for the bands that allow it.
+ *
+ * @note
+ *	main() starts the core at MCU_HFXO_FREQ from the HFRCO. This must be called
+ *	before anything that caches the core clock is opened, since the drivers
+ *	opened later read the band that is set here.
+ *
+ ******************************************************************************/
+void perf_open(void){
+	EMU_EM01Init_TypeDef em01_init = EMU_EM01INIT_DEFAULT;
+
+	client_head = NULL;
+	client_tail = NULL;
+	notify_head = NULL;
+	notify_tail = NULL;
+	changes = 0;
+	release_pending = false;
+
+	em01_init.vScaleEM01LowPowerVoltageEnable = true;
+	EMU_EM01Init(&em01_init);
+	core_hz = CMU_ClockFreqGet(cmuClock_CORE);
+	perf_set(perf_band_hz(0));
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Registers a client that can request a minimum core frequency.
+ *
+ * @details
+ *	Registering a client that is already registered does nothing.
+ *
+ * @param[in] client
+ *   Pointer to the client, which must stay valid while it is registered.
+ *
+ * @param[in] name
+ *   The name shown for the client.
+ *
+ ******************************************************************************/
+void perf_client_register(PERF_CLIENT *client, const char *name){
+	for(PERF_CLIENT *c = client_head; c != NULL; c = c->next){
+		if(c == client){
+			return;
+		}
+	}
+	client->next = NULL;
+	client->name = name;
+	client->min_hz = 0;
+	client->requests = 0;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	if(client_tail == NULL){
+		client_head = client;
+	} else {
+		client_tail->next = client;
+	}
+	client_tail = client;
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Registers a function to be called after every change of the band.
+ *
+ * @details
+ *	The function is also called straight away with the current frequency, so
+ *	a listener that read the clock before perf_open() starts from the band.
+ *
+ * @param[in] notify
+ *   Pointer to the listener, which must stay valid while it is registered.
+ *
+ * @param[in] fn
+ *   The function called with the new core frequency.
+ *
+ ******************************************************************************/
+void perf_notify_register(PERF_NOTIFY *notify, PERF_NOTIFY_FN fn){
+	EFM_ASSERT(fn != NULL);
+
+	for(PERF_NOTIFY *n = notify_head; n != NULL; n = n->next){
+		if(n == notify){
+			return;
+		}
+	}
+	notify->next = NULL;
+	notify->fn = fn;
+	if(notify_tail == NULL){
+		notify_head = notify;
+	} else {
+		notify_tail->next = notify;
+	}
+	notify_tail = notify;
+	fn(core_hz);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Requests a minimum core frequency until the client releases it.
+ *
+ * @details
+ *	The band is raised straight away if it is too slow, so the work that needs
+ *	the frequency can start as soon as this returns. A second request from the
+ *	same client replaces the first.
+ *
+ * @note
+ *	Must be called from the main loop, not from an interrupt handler, since
+ *	the voltage is waited on and the listeners reprogram their peripherals.
+ *
+ * @param[in] client
+ *   The registered client making the request.
+ *
+ * @param[in] min_hz
+ *   The slowest core frequency the work can be done at.
+ *
+ ******************************************************************************/
+void perf_request(PERF_CLIENT *client, uint32_t min_hz){
+	EFM_ASSERT(!CORE_InIrqContext());
+	EFM_ASSERT(min_hz > 0);
+
+	client->min_hz = min_hz;
+	client->requests++;
+	perf_apply();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Releases the client's request.
+ *
+ * @details
+ *	From the main loop the band is lowered straight away. From an interrupt
+ *	handler the band is left where it is until the main loop next calls
+ *	perf_update(), which it does before going to sleep.
+ *
+ * @param[in] client
+ *   The registered client releasing its request.
+ *
+ ******************************************************************************/
+void perf_release(PERF_CLIENT *client){
+	client->min_hz = 0;
+	if(CORE_InIrqContext()){
+		release_pending = true;
+	} else {
+		perf_apply();
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Moves the core to the lowest band that satisfies every outstanding request.
+ *
+ * @note
+ *	Must be called from the main loop, not from an interrupt handler.
+ *
+ ******************************************************************************/
+void perf_apply(void){
+	uint32_t min_hz = 0;
+
+	release_pending = false;
+	for(PERF_CLIENT *c = client_head; c != NULL; c = c->next){
+		if(c->min_hz > min_hz){
+			min_hz = c->min_hz;
+		}
+	}
+	perf_set(perf_band_hz(min_hz));
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Applies the releases made from interrupt handlers since the last call.
+ *
+ * @note
+ *	Called by the main loop each time round, before it sleeps.
+ *
+ ******************************************************************************/
+void perf_update(void){
+	if(release_pending){
+		perf_apply();
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the frequency of the band the core is running from.
+ *
+ ******************************************************************************/
+uint32_t perf_core_hz(void){
+	return core_hz;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of times the band has changed since perf_open().
+ *
+ ******************************************************************************/
+uint32_t perf_changes(void){
+	return changes;
+}
@@ -13,11 +13,14 @@
 //***********************************************************************************
 
 //** Standard Libraries
+#include <stddef.h>
 
 //** Silicon Lab include files
 
 //** User/developer include files
 #include "scheduler.h"
+#include "atomic.h"
+#include "trace.h"
 #include "em_assert.h"
 #include "em_core.h"
 #include "em_emu.h"
@@ -25,8 +28,144 @@
 //***********************************************************************************
 // Private variables
 //***********************************************************************************
-static unsigned int event_scheduled;
+static volatile uint32_t event_summary;
+static volatile uint32_t event_pending[SCHEDULER_PRIORITY_LEVELS];
+static uint32_t slots_used[SCHEDULER_PRIORITY_LEVELS];
+static uint8_t slot_index[SCHEDULER_MAX_EVENTS];
+static uint32_t registered;
+static SCHEDULER_CB event_cb[SCHEDULER_MAX_REGISTERED];
+static uint32_t post_cycles[SCHEDULER_MAX_REGISTERED];
+static uint32_t worst_latency[SCHEDULER_PRIORITY_LEVELS];
+static SCHEDULER_EVENT_STATS event_stats[SCHEDULER_MAX_REGISTERED];
+static SCHEDULER_HOOK dispatch_hook;
+static uint16_t latency_hist[SCHEDULER_MAX_REGISTERED][SCHEDULER_HIST_BUCKETS];
+static uint32_t run_budget[SCHEDULER_MAX_REGISTERED];
+static uint32_t cycles_per_us;
+static uint32_t post_round[SCHEDULER_MAX_REGISTERED];
+static uint32_t dispatch_round;
+static uint32_t violations;
 
+#ifdef SCHEDULER_BENCH_ENABLED
+static SCHEDULER_BENCH_RESULT bench_results[SCHEDULER_WORD_BITS];
+static SCHEDULER_ATOMIC_BENCH_RESULT atomic_bench_result;
+#endif
+
+// An event handle is its slot plus one, and a slot is its priority level and bit.
+// The per-event tables are indexed by the order the event was registered in,
+// which slot_index[] gives for each slot, so they only cover registered events.
+#define	SCHEDULER_NO_INDEX		0xFF
+#define	HANDLE_SLOT(event)		((event) - 1)
+#define	SLOT_LEVEL(slot)		((slot) / SCHEDULER_WORD_BITS)
+#define	SLOT_BIT(slot)			((slot) % SCHEDULER_WORD_BITS)
+#define	SLOT_HANDLE(level, bit)	((level) * SCHEDULER_WORD_BITS + (bit) + 1)
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+static void scheduler_cycle_counter_open(void);
+static void scheduler_hist_add(uint32_t index, uint32_t latency);
+static void remove_scheduled_level(uint32_t level);
+static uint32_t scheduler_next_event(void);
+#ifdef SCHEDULER_BENCH_ENABLED
+static void bench_cb(void);
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *	Enables the Cortex-M4 DWT cycle counter.
+ *
+ * @details
+ *	The cycle counter is used to timestamp events when they are posted and
+ *	dispatched. It only counts while the core is clocked, which is fine since
+ *	the main loop never sleeps while an event is pending. The cycles counted
+ *	are turned into us at the core clock of the dispatch.
+ *
+ ******************************************************************************/
+static void scheduler_cycle_counter_open(void){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Adds a dispatch latency to the histogram of an event.
+ *
+ * @details
+ *	The bucket is the number of significant bits of the latency, found with a
+ *	single count-leading-zeros, so the cost is the same for any latency. A
+ *	bucket stops counting at SCHEDULER_HIST_MAX rather than wrapping to zero.
+ *
+ * @param[in] index
+ *   The registration index of the event.
+ *
+ * @param[in] latency
+ *   Time from the event being posted to it being dispatched, in us.
+ *
+ ******************************************************************************/
+static void scheduler_hist_add(uint32_t index, uint32_t latency){
+	uint32_t bucket = 32 - __CLZ(latency);
+
+	if(bucket >= SCHEDULER_HIST_BUCKETS){
+		bucket = SCHEDULER_HIST_BUCKETS - 1;
+	}
+	if(latency_hist[index][bucket] < SCHEDULER_HIST_MAX){
+		latency_hist[index][bucket]++;
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Clears a priority level from the summary word once its pending word is empty.
+ *
+ * @details
+ *	An interrupt can post to the level after its pending word was found empty
+ *	and before the summary bit is cleared, so the pending word is read again
+ *	afterwards and the summary bit is put back if an event has arrived. Since
+ *	the pending bit is always set before the summary bit, the summary can never
+ *	be left clear while the level has a pending event.
+ *
+ * @param[in] level
+ *   The priority level whose pending word was found empty.
+ *
+ ******************************************************************************/
+static void remove_scheduled_level(uint32_t level){
+	atomic_word_and(&event_summary, ~(1u << level));
+	if(event_pending[level]){
+		atomic_word_or(&event_summary, 1u << level);
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Finds the highest priority pending event.
+ *
+ * @details
+ *	Count-leading-zeros on the summary word picks the highest priority level
+ *	with a pending event, and again on the pending word of that level picks the
+ *	event, so the cost does not grow with the number of registered events. A
+ *	level whose events were all removed since it was marked is cleared from
+ *	the summary word and the next level is tried.
+ *
+ * @return
+ *   The handle of the event, or SCHEDULER_NO_EVENT if none is pending.
+ *
+ ******************************************************************************/
+static uint32_t scheduler_next_event(void){
+	uint32_t summary;
+	uint32_t level;
+	uint32_t pending;
+
+	while((summary = event_summary)){
+		level = 31 - __CLZ(summary);
+		pending = event_pending[level];
+		if(pending){
+			return SLOT_HANDLE(level, 31 - __CLZ(pending));
+		}
+		remove_scheduled_level(level);
+	}
+	return SCHEDULER_NO_EVENT;
+}
 
 //***********************************************************************************
 // Global functions
@@ -37,21 +176,64 @@ static unsigned int event_scheduled;
  *	Driver to open a scheduler for event handlers
  *
  * @details
- *	Initializes the scheduler to have no events scheduled, by utilizing a static
- *	variable that keeps track of which events need to be serviced.
+ *	Initializes the scheduler to have no events scheduled and no events
+ *	registered. Each priority level has a word that keeps track of which of its
+ *	events need to be serviced, and the summary word has a bit for each level
+ *	with at least one pending event.
  *
  * @note
  *	This function is atomic to prevent issues with interrupts changing the event
- *	scheduled bit multiple times.
+ *	scheduled bit multiple times. The core clock is read here, and the
+ *	application keeps it up to date by registering scheduler_clock_set() as a
+ *	perf listener.
  *
  ******************************************************************************/
 void scheduler_open(void){
 	CORE_DECLARE_IRQ_STATE;
 	CORE_ENTER_CRITICAL();
 
-	event_scheduled = 0;
+	event_summary = 0;
+	dispatch_hook = NULL;
+	dispatch_round = 0;
+	registered = 0;
+	for(uint32_t i = 0; i < SCHEDULER_MAX_EVENTS; i++){
+		slot_index[i] = SCHEDULER_NO_INDEX;
+	}
+	for(uint32_t i = 0; i < SCHEDULER_MAX_REGISTERED; i++){
+		event_cb[i] = NULL;
+	}
+	for(uint32_t i = 0; i < SCHEDULER_PRIORITY_LEVELS; i++){
+		event_pending[i] = 0;
+		slots_used[i] = 0;
+		worst_latency[i] = 0;
+	}
+	scheduler_cycle_counter_open();
 
 	CORE_EXIT_CRITICAL();
+
+	scheduler_clock_set(CMU_ClockFreqGet(cmuClock_CORE));
+	scheduler_stats_reset();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets the core clock the measured cycles are converted to us with.
+ *
+ * @details
+ *	Budgets, latencies and histograms are all kept in us, so they keep their
+ *	meaning when the HFRCO band changes and nothing needs to be rescaled or
+ *	reset. A latency or run time that spans a band change is converted at the
+ *	clock of the dispatch, so it is only approximate.
+ *
+ * @param[in] core_hz
+ *   The core clock frequency.
+ *
+ ******************************************************************************/
+void scheduler_clock_set(uint32_t core_hz){
+	cycles_per_us = core_hz / 1000000;
+	if(cycles_per_us == 0){
+		cycles_per_us = 1;
+	}
 }
 
 /***************************************************************************//**
@@ -60,24 +242,42 @@ void scheduler_open(void){
  *
  * @details
  *	This function adds the event to the scheduler through an or-equals function to
- *	the static variable with the event integer. This ensures that other events are
- *	not effected by the adding of a new event.
+ *	the pending word of its priority level, and marks the level in the summary
+ *	word. This ensures that other events are not effected by the adding of a new
+ *	event. The cycle count is recorded when the event goes from idle to pending,
+ *	along with the dispatch round, to measure how long it waits to be dispatched.
+ *	Every post is counted, and a post made while the event is already pending is
+ *	also counted as coalesced, since its handler will only be called once for both.
  *
  * @note
- *	This function is atomic to prevent issues with interrupts changing the event
- *	scheduled bit multiple times.
+ *	The pending bit is set with an exclusive load and store, which tells whether
+ *	the bit was already set, so interrupts are never masked. The word bit is set
+ *	before the summary bit, so the dispatcher never sees a level in the summary
+ *	without also being able to find its event.
  *
  * @param[in] event
- *   An integer that represents an event that needs to be serviced.
+ *   The handle of the event that needs to be serviced.
  *
  ******************************************************************************/
 void add_scheduled_event(uint32_t event){
-	CORE_DECLARE_IRQ_STATE;
-	CORE_ENTER_CRITICAL();
+	uint32_t slot = HANDLE_SLOT(event);
+	uint32_t level = SLOT_LEVEL(slot);
+	uint32_t mask = 1u << SLOT_BIT(slot);
+	uint32_t index;
 
-	event_scheduled |= event;
+	EFM_ASSERT(event != SCHEDULER_NO_EVENT && event <= SCHEDULER_MAX_EVENTS);
+	index = slot_index[slot];
+	EFM_ASSERT(index < SCHEDULER_MAX_REGISTERED);
 
-	CORE_EXIT_CRITICAL();
+	trace_record(TRACE_POST, event);
+	atomic_word_add(&event_stats[index].posts, 1);
+	if(atomic_word_or(&event_pending[level], mask) & mask){
+		atomic_word_add(&event_stats[index].coalesced, 1);
+	} else {
+		post_cycles[index] = DWT->CYCCNT;
+		post_round[index] = dispatch_round;
+	}
+	atomic_word_or(&event_summary, 1u << level);
 }
 
 /***************************************************************************//**
@@ -86,25 +286,30 @@ void add_scheduled_event(uint32_t event){
  *
  * @details
  *	This function removes the event to the scheduler through an and-not-equals function
- *	to the static variable with the event integer. This ensures that other events are
- *	not effected by the removing of a new event.
+ *	to the pending word of its priority level. This ensures that other events are
+ *	not effected by the removing of a new event. The level is cleared from the
+ *	summary word once it has no pending events left.
  *
  * @note
- *	This function is atomic to prevent issues with interrupts changing the event
- *	scheduled bit multiple times.
+ *	Both words are changed with exclusive loads and stores, so interrupts are
+ *	never masked. An interrupt can post to the level between its word being
+ *	found empty and the summary bit being cleared, so the word is checked again
+ *	afterwards and the summary bit is put back if it is no longer empty.
  *
  * @param[in] event
- *   An integer that represents an event that needs to be serviced.
+ *   The handle of the event that no longer needs to be serviced.
  *
  ******************************************************************************/
 void remove_scheduled_event(uint32_t event){
-	CORE_DECLARE_IRQ_STATE;
-	CORE_ENTER_CRITICAL();
-
-	event_scheduled &= ~event;
+	uint32_t slot = HANDLE_SLOT(event);
+	uint32_t level = SLOT_LEVEL(slot);
+	uint32_t mask = 1u << SLOT_BIT(slot);
 
-	CORE_EXIT_CRITICAL();
+	EFM_ASSERT(event != SCHEDULER_NO_EVENT && event <= SCHEDULER_MAX_EVENTS);
 
+	if((atomic_word_and(&event_pending[level], ~mask) & ~mask) == 0){
+		remove_scheduled_level(level);
+	}
 }
 
 /***************************************************************************//**
@@ -112,8 +317,9 @@ void remove_scheduled_event(uint32_t event){
  *	Returns the which events are scheduled.
  *
  * @details
- *	Returns the value of the static variable that keeps track of the scheduled
- *	events
+ *	Returns the summary word, which has a bit set for each priority level with
+ *	at least one pending event, so it is non-zero whenever any event needs to be
+ *	serviced.
  *
  * @note
  *	No need to be atomic, as it only returns and does not change the events that
@@ -121,5 +327,523 @@ void remove_scheduled_event(uint32_t event){
  *
  ******************************************************************************/
 uint32_t get_scheduled_events(void){
-	return event_scheduled;
+	return event_summary;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Registers the handler that services a scheduled event.
+ *
+ * @details
+ *	The event is given the next free bit of the pending word of its priority
+ *	level, starting from the top bit, so events of the same level are
+ *	dispatched in the order they were registered. The returned handle holds the
+ *	level and bit of the event, so posting it goes straight to its bit, and the
+ *	dispatcher goes straight from a pending bit to its handler. The handler,
+ *	budget and counters of the event are kept at the next free registration
+ *	index, so only SCHEDULER_MAX_REGISTERED events can be registered in all.
+ *
+ * @note
+ *	Must be called after scheduler_open(), which clears the handler table. The
+ *	handle is what the drivers are given as the event to post. The handler is
+ *	given the default run time budget, SCHEDULER_BUDGET_DEFAULT.
+ *
+ * @param[in] cb
+ *   The function to call when the event is dispatched.
+ *
+ * @param[in] priority
+ *   The dispatch priority of the event, SCHEDULER_PRIORITY_LOW to
+ *   SCHEDULER_PRIORITY_URGENT.
+ *
+ * @return
+ *   The handle of the event, never SCHEDULER_NO_EVENT.
+ *
+ ******************************************************************************/
+uint32_t scheduler_register_event(SCHEDULER_CB cb, uint32_t priority){
+	uint32_t bit;
+
+	EFM_ASSERT(cb != NULL);
+	EFM_ASSERT(priority < SCHEDULER_PRIORITY_LEVELS);
+	EFM_ASSERT(slots_used[priority] < SCHEDULER_WORD_BITS);
+	EFM_ASSERT(registered < SCHEDULER_MAX_REGISTERED);
+
+	bit = SCHEDULER_WORD_BITS - 1 - slots_used[priority];
+	slots_used[priority]++;
+	event_cb[registered] = cb;
+	run_budget[registered] = SCHEDULER_BUDGET_DEFAULT;
+	slot_index[HANDLE_SLOT(SLOT_HANDLE(priority, bit))] = registered;
+	registered++;
+	return SLOT_HANDLE(priority, bit);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Services pending events in priority order until none are left.
+ *
+ * @details
+ *	Each pass uses count-leading-zeros on the summary word to pick the highest
+ *	priority level with a pending event, and again on the pending word of that
+ *	level to find the event, so the cost does not grow with the number of
+ *	registered events. The event is removed from the scheduler before its
+ *	handler is called, so an interrupt that posts the same event while the
+ *	handler is running is serviced on a later pass. The pending events are read
+ *	again after every handler, so an event that arrives while a slow handler
+ *	runs is serviced before any lower priority event that was already waiting.
+ *	The post time of the event is read before it is removed, so a new post that
+ *	lands between the two is coalesced into this dispatch instead of
+ *	overwriting the time being measured.
+ *
+ * @note
+ *	The time from posting an event to calling its handler is measured with the
+ *	DWT cycle counter and converted to us, and the worst case is kept for each
+ *	priority level and for each event, along with a log2 histogram of each
+ *	event's latency. The dispatch hook, if set, is told of each event before
+ *	its handler is called. Each handler is timed, and a handler that runs
+ *	longer than its budget is counted as an overrun. An event that was pending
+ *	while more than SCHEDULER_STARVE_ROUNDS other events were dispatched is
+ *	counted as starved.
+ *
+ ******************************************************************************/
+void scheduler_dispatch(void){
+	uint32_t level;
+	uint32_t event;
+	uint32_t index;
+	uint32_t latency;
+	uint32_t rounds;
+	uint32_t start;
+
+	while((event = scheduler_next_event()) != SCHEDULER_NO_EVENT){
+		level = SLOT_LEVEL(HANDLE_SLOT(event));
+		index = slot_index[HANDLE_SLOT(event)];
+		latency = (DWT->CYCCNT - post_cycles[index]) / cycles_per_us;
+		rounds = dispatch_round - post_round[index];
+		remove_scheduled_event(event);
+		if(latency > worst_latency[level]){
+			worst_latency[level] = latency;
+		}
+		if(latency > event_stats[index].max_pending){
+			event_stats[index].max_pending = latency;
+		}
+		event_stats[index].dispatches++;
+		scheduler_hist_add(index, latency);
+		if(rounds > event_stats[index].max_rounds){
+			event_stats[index].max_rounds = rounds;
+		}
+		if(rounds > SCHEDULER_STARVE_ROUNDS){
+			event_stats[index].starved++;
+			violations++;
+		}
+		dispatch_round++;
+		trace_record(TRACE_DISPATCH, event);
+		if(dispatch_hook != NULL){
+			dispatch_hook(event);
+		}
+
+		start = DWT->CYCCNT;
+		event_cb[index]();
+		latency = (DWT->CYCCNT - start) / cycles_per_us;
+		if(latency > event_stats[index].max_run){
+			event_stats[index].max_run = latency;
+		}
+		if(latency > run_budget[index]){
+			event_stats[index].overruns++;
+			violations++;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the worst case dispatch latency of a priority level.
+ *
+ * @details
+ *	The latency is the time from the event being posted with
+ *	add_scheduled_event() to its handler being called.
+ *
+ * @param[in] priority
+ *   The priority level, SCHEDULER_PRIORITY_LOW to SCHEDULER_PRIORITY_URGENT.
+ *
+ * @return
+ *   The longest latency seen at this level since the last reset, in us.
+ *
+ ******************************************************************************/
+uint32_t scheduler_worst_latency(uint32_t priority){
+	EFM_ASSERT(priority < SCHEDULER_PRIORITY_LEVELS);
+	return worst_latency[priority];
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Clears the worst case dispatch latency of every priority level.
+ *
+ ******************************************************************************/
+void scheduler_latency_reset(void){
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	for(uint32_t i = 0; i < SCHEDULER_PRIORITY_LEVELS; i++){
+		worst_latency[i] = 0;
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Reads the counters of a registered event.
+ *
+ * @details
+ *	The counters are copied inside a critical section, so an interrupt posting
+ *	the event cannot update them part way through the copy. The difference
+ *	between posts and coalesced is the number of times the event went from idle
+ *	to pending, which should match the number of dispatches.
+ *
+ * @note
+ *	A coalesced post is lost work unless the poster keeps its own record of it,
+ *	such as an event queue, which posts the event again for every entry.
+ *
+ * @param[in] event
+ *   The handle of the event.
+ *
+ * @param[out] stats
+ *   Pointer to the struct the counters are copied to.
+ *
+ * @return
+ *   Returns false if no handler is registered for the event.
+ *
+ ******************************************************************************/
+bool scheduler_get_stats(uint32_t event, SCHEDULER_EVENT_STATS *stats){
+	uint32_t index;
+
+	if(event == SCHEDULER_NO_EVENT || event > SCHEDULER_MAX_EVENTS){
+		return false;
+	}
+	index = slot_index[HANDLE_SLOT(event)];
+	if(index == SCHEDULER_NO_INDEX){
+		return false;
+	}
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	*stats = event_stats[index];
+
+	CORE_EXIT_CRITICAL();
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Reads the dispatch latency histogram of a registered event.
+ *
+ * @details
+ *	Bucket 0 counts latencies under 1 us and bucket n counts latencies from
+ *	2^(n-1) to 2^n - 1 us, with the last bucket also counting every longer
+ *	latency. The latency is measured from the event going from idle to pending,
+ *	normally in an interrupt handler, to its handler being called.
+ *
+ * @param[in] event
+ *   The handle of the event.
+ *
+ * @param[out] hist
+ *   Array of SCHEDULER_HIST_BUCKETS counts the histogram is copied to.
+ *
+ * @return
+ *   Returns false if no handler is registered for the event.
+ *
+ ******************************************************************************/
+bool scheduler_get_histogram(uint32_t event, uint16_t *hist){
+	uint32_t index;
+
+	if(event == SCHEDULER_NO_EVENT || event > SCHEDULER_MAX_EVENTS){
+		return false;
+	}
+	index = slot_index[HANDLE_SLOT(event)];
+	if(index == SCHEDULER_NO_INDEX){
+		return false;
+	}
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	for(uint32_t i = 0; i < SCHEDULER_HIST_BUCKETS; i++){
+		hist[i] = latency_hist[index][i];
+	}
+
+	CORE_EXIT_CRITICAL();
+	return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Clears the counters and latency histograms of every event.
+ *
+ ******************************************************************************/
+void scheduler_stats_reset(void){
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	for(uint32_t i = 0; i < SCHEDULER_MAX_REGISTERED; i++){
+		event_stats[i].posts = 0;
+		event_stats[i].coalesced = 0;
+		event_stats[i].dispatches = 0;
+		event_stats[i].max_pending = 0;
+		event_stats[i].max_run = 0;
+		event_stats[i].overruns = 0;
+		event_stats[i].max_rounds = 0;
+		event_stats[i].starved = 0;
+		for(uint32_t j = 0; j < SCHEDULER_HIST_BUCKETS; j++){
+			latency_hist[i][j] = 0;
+		}
+	}
+	violations = 0;
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets the run time budget of an event's handler.
+ *
+ * @details
+ *	Each time the handler runs longer than the budget, the overrun counter of
+ *	the event is incremented. Use SCHEDULER_BUDGET_NONE for handlers that are
+ *	expected to run long, such as the boot up self tests.
+ *
+ * @param[in] event
+ *   The handle of the event.
+ *
+ * @param[in] us
+ *   The longest the handler may run, in us at any core clock.
+ *
+ ******************************************************************************/
+void scheduler_set_budget(uint32_t event, uint32_t us){
+	EFM_ASSERT(event != SCHEDULER_NO_EVENT && event <= SCHEDULER_MAX_EVENTS);
+	EFM_ASSERT(slot_index[HANDLE_SLOT(event)] != SCHEDULER_NO_INDEX);
+	run_budget[slot_index[HANDLE_SLOT(event)]] = us;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of budget overruns and starved events of all events.
+ *
+ * @details
+ *	A quick check for the application, which can then read the counters of
+ *	each event with scheduler_get_stats() to find the handler at fault.
+ *
+ ******************************************************************************/
+uint32_t scheduler_violations(void){
+	return violations;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets the function that is told of every event as it is dispatched.
+ *
+ * @details
+ *	Lets the task facility see events that its tasks are waiting on without
+ *	the handlers of those events knowing about the tasks.
+ *
+ * @param[in] hook
+ *   The function to call with each dispatched event, or NULL for none.
+ *
+ ******************************************************************************/
+void scheduler_set_dispatch_hook(SCHEDULER_HOOK hook){
+	dispatch_hook = hook;
+}
+
+#ifdef SCHEDULER_BENCH_ENABLED
+/***************************************************************************//**
+ * @brief
+ *	Handler used by the dispatch benchmark.
+ *
+ ******************************************************************************/
+static void bench_cb(void){
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Compares the cost of the count-leading-zeros lookup against the original if-chain.
+ *
+ * @details
+ *	For every number of defined events from 1 to 32, the highest event is made
+ *	pending and the DWT cycle counter measures how long each method takes to
+ *	find it, remove it and call its handler. The if-chain is modelled the way
+ *	main.c used to service events, reading the scheduled events and testing one
+ *	bit for each defined event. The table path is scheduler_next_event(), the
+ *	lookup scheduler_dispatch() uses, so the latency, statistics, trace and
+ *	hook work that scheduler_dispatch() adds for every event is left out of both
+ *	numbers. Both call the handler through the same local table. All events are
+ *	placed in the pending word of the normal priority level for the benchmark.
+ *	The results are stored in bench_results[] to be read out with the debugger.
+ *
+ * @note
+ *	The scheduled events are saved and restored, so the benchmark can run from
+ *	the boot up event, and the registered handlers and counters are not touched.
+ *	It runs with interrupts disabled so the measurements are not disturbed.
+ *
+ ******************************************************************************/
+void scheduler_dispatch_bench(void){
+	SCHEDULER_CB bench_table[SCHEDULER_WORD_BITS];
+	uint32_t saved_pending[SCHEDULER_PRIORITY_LEVELS];
+	uint32_t saved_summary;
+	uint32_t level = SCHEDULER_PRIORITY_NORMAL;
+	uint32_t start;
+	uint32_t defined;
+	uint32_t event;
+
+	for(uint32_t i = 0; i < SCHEDULER_WORD_BITS; i++){
+		bench_table[i] = bench_cb;
+	}
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	saved_summary = event_summary;
+	for(uint32_t i = 0; i < SCHEDULER_PRIORITY_LEVELS; i++){
+		saved_pending[i] = event_pending[i];
+		event_pending[i] = 0;
+	}
+
+	for(defined = 1; defined <= SCHEDULER_WORD_BITS; defined++){
+		event_pending[level] = 1u << (defined - 1);
+		event_summary = 1u << level;
+		start = DWT->CYCCNT;
+		for(uint32_t i = 0; i < defined; i++){
+			if(event_pending[level] & (1u << i)){
+				remove_scheduled_event(SLOT_HANDLE(level, i));
+				bench_table[i]();
+			}
+		}
+		bench_results[defined - 1].chain_cycles = DWT->CYCCNT - start;
+
+		event_pending[level] = 1u << (defined - 1);
+		event_summary = 1u << level;
+		start = DWT->CYCCNT;
+		event = scheduler_next_event();
+		remove_scheduled_event(event);
+		bench_table[SLOT_BIT(HANDLE_SLOT(event))]();
+		bench_results[defined - 1].dispatch_cycles = DWT->CYCCNT - start;
+		EFM_ASSERT(event == SLOT_HANDLE(level, defined - 1));
+	}
+
+	for(uint32_t i = 0; i < SCHEDULER_PRIORITY_LEVELS; i++){
+		event_pending[i] = saved_pending[i];
+	}
+	event_summary = saved_summary;
+
+	CORE_EXIT_CRITICAL();
+
+	EFM_ASSERT(bench_results[SCHEDULER_WORD_BITS - 1].dispatch_cycles <
+			bench_results[SCHEDULER_WORD_BITS - 1].chain_cycles);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Compares posting and removing an event with atomics against a critical section.
+ *
+ * @details
+ *	The critical section version is a copy of how add_scheduled_event() and
+ *	remove_scheduled_event() were written before they used exclusive access,
+ *	including the trace record of the post. For each version,
+ *	SCHEDULER_BENCH_ROUNDS post and remove pairs of one event are timed with
+ *	the DWT cycle counter, and for the critical section version the cycles from
+ *	masking to unmasking interrupts are also added up. The averages per pair are
+ *	stored in atomic_bench_result to be read out with the debugger. The atomic
+ *	version never masks interrupts, so critical_masked is the interrupt disabled
+ *	time removed from every post and remove.
+ *
+ * @note
+ *	Both versions are checked to leave the same pending and summary bits, and
+ *	the summary bit of a level is checked to be put back when an event arrives
+ *	between its pending word being found empty and the summary being cleared.
+ *	The loops run with interrupts enabled, so each version pays for its own
+ *	masking only. The benchmark uses the last bit of the lowest level, which no
+ *	registered event is given, and borrows the next free registration index for
+ *	its counters. Any event an interrupt posts meanwhile is kept. The trace is frozen while the loops run, so both versions pay the
+ *	same early return from trace_record() and the ring is not filled with posts.
+ *
+ ******************************************************************************/
+void scheduler_atomic_bench(void){
+	uint32_t level = SCHEDULER_PRIORITY_LOW;
+	uint32_t event = SLOT_HANDLE(level, 0);
+	uint32_t slot = HANDLE_SLOT(event);
+	uint32_t index = registered;
+	uint32_t mask = 1u;
+	uint32_t start;
+	uint32_t entered;
+	uint32_t masked;
+	uint32_t critical;
+	uint32_t atomic;
+	CORE_irqState_t post_state;
+	CORE_irqState_t remove_state;
+	CORE_irqState_t restore_state;
+
+	EFM_ASSERT(slots_used[level] < SCHEDULER_WORD_BITS);
+	EFM_ASSERT(index < SCHEDULER_MAX_REGISTERED);
+	EFM_ASSERT(!(event_pending[level] & mask));
+
+	slot_index[slot] = index;
+	trace_freeze();
+	critical = 0;
+	masked = 0;
+	for(uint32_t i = 0; i < SCHEDULER_BENCH_ROUNDS; i++){
+		start = DWT->CYCCNT;
+		trace_record(TRACE_POST, event);
+		post_state = CORE_EnterCritical();
+		entered = DWT->CYCCNT;
+		event_stats[index].posts++;
+		if(event_pending[level] & mask){
+			event_stats[index].coalesced++;
+		} else {
+			post_cycles[index] = DWT->CYCCNT;
+			post_round[index] = dispatch_round;
+		}
+		event_pending[level] |= mask;
+		event_summary |= 1u << level;
+		masked += DWT->CYCCNT - entered;
+		CORE_ExitCritical(post_state);
+		EFM_ASSERT((event_pending[level] & mask) && (event_summary & (1u << level)));
+		remove_state = CORE_EnterCritical();
+		entered = DWT->CYCCNT;
+		event_pending[level] &= ~mask;
+		if(!event_pending[level]){
+			event_summary &= ~(1u << level);
+		}
+		masked += DWT->CYCCNT - entered;
+		CORE_ExitCritical(remove_state);
+		critical += DWT->CYCCNT - start;
+		EFM_ASSERT(!(event_pending[level] & mask));
+	}
+
+	atomic = 0;
+	for(uint32_t i = 0; i < SCHEDULER_BENCH_ROUNDS; i++){
+		start = DWT->CYCCNT;
+		add_scheduled_event(event);
+		atomic += DWT->CYCCNT - start;
+		EFM_ASSERT((event_pending[level] & mask) && (event_summary & (1u << level)));
+		start = DWT->CYCCNT;
+		remove_scheduled_event(event);
+		atomic += DWT->CYCCNT - start;
+		EFM_ASSERT(!(event_pending[level] & mask));
+	}
+	trace_resume();
+	slot_index[slot] = SCHEDULER_NO_INDEX;
+
+	atomic_bench_result.critical_cycles = critical / SCHEDULER_BENCH_ROUNDS;
+	atomic_bench_result.critical_masked = masked / SCHEDULER_BENCH_ROUNDS;
+	atomic_bench_result.atomic_cycles = atomic / SCHEDULER_BENCH_ROUNDS;
+
+	restore_state = CORE_EnterCritical();
+	if(!event_pending[level]){
+		event_pending[level] = mask;
+		remove_scheduled_level(level);
+		EFM_ASSERT(event_summary & (1u << level));
+		event_pending[level] = 0;
+		remove_scheduled_level(level);
+	}
+	CORE_ExitCritical(restore_state);
+	scheduler_latency_reset();
+	scheduler_stats_reset();
 }
+#endif
@@ -34,22 +34,292 @@
 
 
 #include "sleep_routines.h"
+#include "sw_timer.h"
+#include "trace.h"
 
-static int lowest_energy_mode[MAX_ENERGY_MODES];
+static uint32_t block_count[MAX_ENERGY_MODES];
+static volatile uint32_t blocked_mask;
+static SLEEP_DECISION_STATS decision_stats[MAX_ENERGY_MODES];
+static SLEEP_RESIDENCY residency[MAX_ENERGY_MODES];
+static uint32_t residency_start;
+static uint32_t awake_since;
+static SLEEP_OWNER *owner_head;
+static SLEEP_OWNER *owner_tail;
+static SLEEP_HOOK *hooks[SLEEP_MAX_HOOKS];
+static uint32_t hook_count;
+static uint32_t hook_min_mode;
+static uint32_t hook_mode;
+static uint32_t presleep_cycles;
+static SLEEP_LATENCY latency[MAX_ENERGY_MODES];
+static uint32_t idle_avg_us;
+static bool idle_avg_valid;
+static uint32_t cycles_per_us;
+
+// Wakeup time of each energy mode in us from the EFM32PG12 datasheet, the part
+// spent before the core runs again, which the cycle counter cannot measure
+static const uint32_t sleep_wakeup_us[MAX_ENERGY_MODES] = {0, 1, 11, 11, 90};
+
+/***************************************************************************//**
+ * @brief
+ *	Adds a sample to a moving average.
+ *
+ * @details
+ *	Each new sample is weighed by 1 / 2^SLEEP_AVG_SHIFT, so the average follows
+ *	a change in the samples within a few tens of samples.
+ *
+ ******************************************************************************/
+static uint32_t sleep_average(uint32_t avg, uint32_t sample){
+	return avg - (avg >> SLEEP_AVG_SHIFT) + (sample >> SLEEP_AVG_SHIFT);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Records the measured latency of a sleep and updates the mode's break-even time.
+ *
+ * @details
+ *	The entry latency runs from choosing the mode until the last suspend hook
+ *	has run, just before the WFI, and the exit latency from the WFI until emlib
+ *	has restored the clocks and the resume hooks have run. The cycle counter is
+ *	stopped while the core sleeps, so neither includes the time asleep. The
+ *	first sample of a mode seeds its averages. The break-even time is the
+ *	datasheet wakeup time plus the measured latency, times SLEEP_COST_FACTOR.
+ *
+ * @param[in] mode
+ *  The energy mode that was entered.
+ *
+ * @param[in] entry
+ *  Core cycles spent entering the mode.
+ *
+ * @param[in] exit
+ *  Core cycles spent leaving the mode.
+ *
+ ******************************************************************************/
+static void sleep_latency_update(uint32_t mode, uint32_t entry, uint32_t exit){
+	SLEEP_LATENCY *lat = &latency[mode];
+
+	if(lat->entry_cycles == 0 && lat->exit_cycles == 0){
+		lat->entry_cycles = entry;
+		lat->exit_cycles = exit;
+	} else {
+		lat->entry_cycles = sleep_average(lat->entry_cycles, entry);
+		lat->exit_cycles = sleep_average(lat->exit_cycles, exit);
+	}
+	lat->break_even_us = (sleep_wakeup_us[mode] +
+			(lat->entry_cycles + lat->exit_cycles) / cycles_per_us) * SLEEP_COST_FACTOR;
+}
 
 /***************************************************************************//**
  * @brief
  *	Driver to open the sleep routines.
  *
  * @details
- *	Uses an array of the energy modes so that sleep modes can be marked as
- *	blocked or allowed based on their value in the array (0 = allowed, >0 =
- *	blocked). This function initializes all energy modes to be allowed.
+ *	Keeps a count of the blocks on each energy mode so that several drivers can
+ *	block the same mode, and a bitmask with a bit set for every mode whose count
+ *	is not zero, so the arbiter never has to look at the counts. This function
+ *	initializes all energy modes to be allowed.
+ *
+ * @note
+ *	The core clock must be set before this is called, since the measured sleep
+ *	latencies are converted from core clock cycles.
  *
  ******************************************************************************/
 void sleep_open(void){
 	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
-		lowest_energy_mode[i] = 0;
+		block_count[i] = 0;
+	}
+	blocked_mask = 0;
+	owner_head = NULL;
+	owner_tail = NULL;
+	hook_count = 0;
+	hook_min_mode = MAX_ENERGY_MODES;
+	hook_mode = EM0;
+	sleep_clock_set(CMU_ClockFreqGet(cmuClock_CORE));
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		latency[i].entry_cycles = 0;
+		latency[i].exit_cycles = 0;
+		latency[i].break_even_us = sleep_wakeup_us[i] * SLEEP_COST_FACTOR;
+	}
+	idle_avg_us = 0;
+	idle_avg_valid = false;
+	sleep_decision_reset();
+	sleep_residency_reset();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Registers a client that blocks sleep modes.
+ *
+ * @details
+ *	Every block and unblock is made by an owner, which keeps its own counts so
+ *	that a block which is never released can be traced back to the client that
+ *	made it. Registering an owner that is already registered has no effect.
+ *
+ * @note
+ *	Must be called after sleep_open() and before the owner's first block.
+ *
+ * @param[in] owner
+ *  Pointer to the owner, which must stay valid for as long as the program runs.
+ *
+ * @param[in] name
+ *  Name of the owner, used in the leak report.
+ *
+ * @param[in] max_hold_ms
+ *  The longest the owner is expected to hold a block, or SLEEP_HOLD_UNLIMITED for
+ *  an owner that holds its blocks for as long as it is running.
+ *
+ ******************************************************************************/
+void sleep_owner_register(SLEEP_OWNER *owner, const char *name, uint32_t max_hold_ms){
+	for(SLEEP_OWNER *o = owner_head; o != NULL; o = o->next){
+		if(o == owner){
+			return;
+		}
+	}
+	owner->next = NULL;
+	owner->name = name;
+	owner->max_hold_ms = max_hold_ms;
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		owner->blocks[i] = 0;
+	}
+	owner->held = 0;
+	owner->total = 0;
+	owner->last_block = 0;
+	owner->held_since = 0;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	if(owner_tail == NULL){
+		owner_head = owner;
+	} else {
+		owner_tail->next = owner;
+	}
+	owner_tail = owner;
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets the core clock the measured sleep latencies are converted with.
+ *
+ * @details
+ *	The latencies are averaged in cycles, so the break-even times follow the
+ *	new clock from the next sleep that is measured.
+ *
+ * @param[in] core_hz
+ *  The core clock frequency.
+ *
+ ******************************************************************************/
+void sleep_clock_set(uint32_t core_hz){
+	cycles_per_us = core_hz / 1000000;
+	if(cycles_per_us == 0){
+		cycles_per_us = 1;
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Registers a peripheral's suspend and resume hooks.
+ *
+ * @details
+ *	The suspend hooks run from EMU_EM23PresleepHook() in order, lowest first,
+ *	and the resume hooks from EMU_EM23PostsleepHook() in the reverse order. A
+ *	hook only runs when the mode being entered is min_mode or deeper, so a
+ *	peripheral is only gated for the sleeps that would stop it anyway, and a
+ *	sleep shallower than every hook's min_mode does not walk the list at all.
+ *	EM1 sleeps never run the hooks.
+ *
+ * @note
+ *	Must be called after sleep_open(). The hooks run with interrupts disabled
+ *	and add to the wakeup time, so they must be short.
+ *
+ * @param[in] hook
+ *  Pointer to the hook, which must stay valid for as long as the program runs.
+ *
+ * @param[in] suspend
+ *  Called with the energy mode before the core sleeps.
+ *
+ * @param[in] resume
+ *  Called with the energy mode once the core has woken up, or NULL for none.
+ *
+ * @param[in] min_mode
+ *  The shallowest energy mode the hook runs for, EM2 or EM3.
+ *
+ * @param[in] order
+ *  The position of the hook, from the sleep_hook_order enum. Hooks of the same
+ *  order run in the order they were registered.
+ *
+ ******************************************************************************/
+void sleep_hook_register(SLEEP_HOOK *hook, SLEEP_HOOK_FN suspend, SLEEP_HOOK_FN resume,
+		uint32_t min_mode, uint32_t order){
+	uint32_t i;
+
+	EFM_ASSERT(hook_count < SLEEP_MAX_HOOKS);
+	EFM_ASSERT(min_mode >= EM2 && min_mode <= EM3);
+
+	hook->suspend = suspend;
+	hook->resume = resume;
+	hook->min_mode = min_mode;
+	hook->order = order;
+	hook->runs = 0;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	i = hook_count;
+	while(i > 0 && hooks[i - 1]->order > order){
+		hooks[i] = hooks[i - 1];
+		i--;
+	}
+	hooks[i] = hook;
+	hook_count++;
+	if(min_mode < hook_min_mode){
+		hook_min_mode = min_mode;
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Runs the suspend hooks, called by emlib just before the core sleeps in EM2 or EM3.
+ *
+ * @details
+ *	Replaces the weak definition in em_emu.c. The mode being entered is set by
+ *	enter_sleep_tickless() before it calls EMU_EnterEM2() or EMU_EnterEM3().
+ *	The cycle counter is read last, to split the measured latency into the
+ *	entry and the exit.
+ *
+ ******************************************************************************/
+void EMU_EM23PresleepHook(void){
+	if(hook_mode >= hook_min_mode){
+		for(uint32_t i = 0; i < hook_count; i++){
+			if(hook_mode >= hooks[i]->min_mode){
+				hooks[i]->suspend(hook_mode);
+				hooks[i]->runs++;
+			}
+		}
+	}
+	presleep_cycles = DWT->CYCCNT;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Runs the resume hooks, called by emlib once the core wakes up from EM2 or EM3.
+ *
+ * @details
+ *	Replaces the weak definition in em_emu.c. Exactly the hooks that were
+ *	suspended are resumed, in the reverse order.
+ *
+ ******************************************************************************/
+void EMU_EM23PostsleepHook(void){
+	if(hook_mode < hook_min_mode){
+		return;
+	}
+	for(uint32_t i = hook_count; i > 0; i--){
+		if(hook_mode >= hooks[i - 1]->min_mode && hooks[i - 1]->resume != NULL){
+			hooks[i - 1]->resume(hook_mode);
+		}
 	}
 }
 
@@ -58,26 +328,47 @@ void sleep_open(void){
  *	Blocks a sleep mode from being entered
  *
  * @details
- *	Adds one to the energy mode's array value. This ensures that if other operations
+ *	Adds one to the energy mode's block count, and sets its bit in the blocked
+ *	mode bitmask when the count leaves zero. This ensures that if other operations
  *	need the sleep mode blocked, they still have the ability to declare when the
- *	sleep mode is allowed/blocked.
+ *	sleep mode is allowed/blocked. The owner's count of the mode is also added to,
+ *	along with the time of the block and, if the owner held no other block, the
+ *	time the owner started holding.
  *
  * @note
- *	This function is atomic to prevent interrupts from potentially creating errors.
+ *	This function is atomic so the count and bitmask always agree, even when an
+ *	interrupt blocks or unblocks the same mode. The critical section is only a
+ *	few instructions long.
+ *
+ * @param[in] owner
+ *  The registered owner making the block.
  *
  * @param[in] EM
  *  The energy mode in question that needs to be blocked. Values defined in the
  *  sleep_routines.h file.
  *
  ******************************************************************************/
-void sleep_block_mode(uint32_t EM){
+void sleep_block_mode(SLEEP_OWNER *owner, uint32_t EM){
+	uint32_t now = sw_timer_now();
+
+	EFM_ASSERT(EM < MAX_ENERGY_MODES);
+	EFM_ASSERT(owner->name != NULL);
+
 	CORE_DECLARE_IRQ_STATE;
 	CORE_ENTER_CRITICAL();
 
-	lowest_energy_mode[EM]++;
+	block_count[EM]++;
+	blocked_mask |= SLEEP_BLOCK_BIT(EM);
+	if(owner->held == 0){
+		owner->held_since = now;
+	}
+	owner->blocks[EM]++;
+	owner->held++;
+	owner->total++;
+	owner->last_block = now;
 
 	CORE_EXIT_CRITICAL();
-	EFM_ASSERT(lowest_energy_mode[EM] < 5);
+	EFM_ASSERT(block_count[EM] < SLEEP_MAX_BLOCKS);
 }
 
 /***************************************************************************//**
@@ -85,31 +376,127 @@ void sleep_block_mode(uint32_t EM){
  *	Removes a sleep mode block
  *
  * @details
- *	Removes one from the energy mode's array value. This ensures that if other operations
- *	need the sleep mode blocked, they still have the ability to declare when the
- *	sleep mode is allowed/blocked.
+ *	Removes one from the energy mode's block count, and clears its bit in the
+ *	blocked mode bitmask when the count reaches zero. This ensures that if other
+ *	operations need the sleep mode blocked, they still have the ability to declare
+ *	when the sleep mode is allowed/blocked.
  *
  * @note
- *	This function is atomic to prevent interrupts from potentially creating errors.
- *	The array value should never fall below zero, as that represents an imbalance
- *	in blocking/allowing sleep modes.
+ *	This function is atomic so the count and bitmask always agree. An owner
+ *	unblocking a mode it has not blocked is an imbalance in blocking/allowing
+ *	sleep modes, so it asserts and has no effect.
+ *
+ * @param[in] owner
+ *  The registered owner that made the block.
  *
  * @param[in] EM
  *  The energy mode in question that needs to be blocked. Values defined in the
  *  sleep_routines.h file.
  *
  ******************************************************************************/
-void sleep_unblock_mode(uint32_t EM){
+void sleep_unblock_mode(SLEEP_OWNER *owner, uint32_t EM){
+	EFM_ASSERT(EM < MAX_ENERGY_MODES);
+	EFM_ASSERT(owner->blocks[EM] > 0);
+
 	CORE_DECLARE_IRQ_STATE;
 	CORE_ENTER_CRITICAL();
 
-	if(lowest_energy_mode[EM] > 0){
-		lowest_energy_mode[EM]--;
+	if(owner->blocks[EM] > 0){
+		owner->blocks[EM]--;
+		owner->held--;
+		block_count[EM]--;
+		if(block_count[EM] == 0){
+			blocked_mask &= ~SLEEP_BLOCK_BIT(EM);
+		}
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns a registered owner by its position in registration order.
+ *
+ * @param[in] index
+ *  The position of the owner, starting from 0.
+ *
+ * @return
+ *  The owner, or NULL once index is past the last owner.
+ *
+ ******************************************************************************/
+const SLEEP_OWNER *sleep_owner_get(uint32_t index){
+	SLEEP_OWNER *owner = owner_head;
+
+	while(owner != NULL && index > 0){
+		owner = owner->next;
+		index--;
 	}
+	return owner;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns how long an owner has been holding a block.
+ *
+ * @details
+ *	The hold starts when the owner goes from holding no blocks to holding one,
+ *	so an owner that keeps blocking again before releasing its last block is
+ *	still timed from the start of the hold.
+ *
+ * @param[in] owner
+ *  The owner being checked.
+ *
+ * @return
+ *  Milliseconds the owner has held a block, or 0 if it holds none.
+ *
+ ******************************************************************************/
+uint32_t sleep_owner_held_ms(const SLEEP_OWNER *owner){
+	uint32_t held_since;
+	uint32_t held;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	held = owner->held;
+	held_since = owner->held_since;
 
 	CORE_EXIT_CRITICAL();
 
-	EFM_ASSERT(lowest_energy_mode[EM] >= 0);
+	if(held == 0){
+		return 0;
+	}
+	return (uint64_t)(sw_timer_now() - held_since) * 1000 / SW_TIMER_HZ;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns whether an owner has held a block for longer than it should.
+ *
+ * @param[in] owner
+ *  The owner being checked.
+ *
+ ******************************************************************************/
+bool sleep_owner_leaking(const SLEEP_OWNER *owner){
+	if(owner->max_hold_ms == SLEEP_HOLD_UNLIMITED){
+		return false;
+	}
+	return sleep_owner_held_ms(owner) > owner->max_hold_ms;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of owners that have held a block for longer than they should.
+ *
+ ******************************************************************************/
+uint32_t sleep_owner_leaks(void){
+	uint32_t leaks = 0;
+
+	for(SLEEP_OWNER *owner = owner_head; owner != NULL; owner = owner->next){
+		if(sleep_owner_leaking(owner)){
+			leaks++;
+		}
+	}
+	return leaks;
 }
 
 /***************************************************************************//**
@@ -122,43 +509,386 @@ void sleep_unblock_mode(uint32_t EM){
  *	that it can be based on the operations occurring.
  *
  * @note
- *	This function is atomic to prevent interrupts from causing errors by changing
- *	the lowest energy mode partway through the function.
+ *	Same as the tickless idle when no deadline is known.
  *
  ******************************************************************************/
 void enter_sleep(void){
+	enter_sleep_tickless(SLEEP_IDLE_UNKNOWN);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sleeps in the deepest energy mode that is allowed and worth entering before
+ *	the next deadline.
+ *
+ * @details
+ *	The deepest mode allowed by the blocks is found with sleep_deepest_allowed(),
+ *	limited to EM3, and is then made shallower until the predicted idle time is at
+ *	least the break-even time of the mode, so the core does not pay for a deep sleep
+ *	that it would have to leave right away. The idle time is predicted from the
+ *	next known deadline, or from the moving average of the recent sleeps when
+ *	there is none. The entry and exit latency of every sleep are measured with
+ *	the cycle counter to keep the break-even times up to date. The number of
+ *	times each mode is chosen, how often it was chosen over a deeper mode and
+ *	how often on the moving average are kept for each mode.
+ *	The RTCC is read on entry and on exit to add the time asleep to the residency
+ *	of the mode, and the time awake since the last exit to the residency of EM0.
+ *	The mode is recorded for the suspend and resume hooks run by emlib.
+ *
+ * @note
+ *	This function is atomic to prevent interrupts from causing errors by changing
+ *	the lowest energy mode partway through the function. The time asleep is
+ *	measured with the software timer RTCC, which keeps counting in EM2 and EM3.
+ *	Its 1 ms tick is coarse next to a short sleep, but the tick boundaries fall
+ *	at random points in each sleep, so the totals are accurate over many sleeps.
+ *
+ * @param[in] idle_ms
+ *  Milliseconds until the next known deadline, or SLEEP_IDLE_UNKNOWN.
+ *
+ ******************************************************************************/
+void enter_sleep_tickless(uint32_t idle_ms){
+	uint32_t allowed;
+	uint32_t mode;
+	uint32_t idle_us;
+	uint32_t start;
+	uint32_t slept;
+	uint32_t start_cycles;
+	uint32_t end_cycles;
+	bool predicted;
+
 	CORE_DECLARE_IRQ_STATE;
 	CORE_ENTER_CRITICAL();
 
-	if(lowest_energy_mode[EM0] > 0){
-	} else if (lowest_energy_mode[EM1] > 0){
-	} else if (lowest_energy_mode[EM2] > 0){
-		EMU_EnterEM1();
-	} else if (lowest_energy_mode[EM3] > 0){
-		EMU_EnterEM2(1);
+	start_cycles = DWT->CYCCNT;
+	allowed = sleep_deepest_allowed();
+	if(allowed > EM3){
+		allowed = EM3;
+	}
+
+	predicted = false;
+	if(idle_ms < SLEEP_IDLE_UNKNOWN / 1000){
+		idle_us = idle_ms * 1000;
+	} else if(idle_avg_valid){
+		idle_us = idle_avg_us;
+		predicted = true;
 	} else {
-		EMU_EnterEM3(1);
+		idle_us = SLEEP_IDLE_UNKNOWN;
+	}
+	mode = allowed;
+	while(mode > EM1 && idle_us < latency[mode].break_even_us){
+		mode--;
+	}
+
+	if(mode != EM0){
+		trace_record(TRACE_SLEEP, mode);
+		start = sw_timer_now();
+		residency[EM0].ticks += start - awake_since;
+		hook_mode = mode;
+		presleep_cycles = DWT->CYCCNT;
+		if(mode == EM1){
+			EMU_EnterEM1();
+		} else if(mode == EM2){
+			EMU_EnterEM2(1);
+		} else {
+			EMU_EnterEM3(1);
+		}
+		end_cycles = DWT->CYCCNT;
+		hook_mode = EM0;
+		sleep_latency_update(mode, presleep_cycles - start_cycles, end_cycles - presleep_cycles);
+		awake_since = sw_timer_now();
+		slept = awake_since - start;
+		if(idle_avg_valid){
+			idle_avg_us = sleep_average(idle_avg_us, slept * (1000000 / SW_TIMER_HZ));
+		} else {
+			idle_avg_us = slept * (1000000 / SW_TIMER_HZ);
+			idle_avg_valid = true;
+		}
+		trace_record(TRACE_WAKE, (slept > 0xFFFF) ? 0xFFFF : slept);
+		residency[mode].ticks += slept;
+		residency[mode].entries++;
+		residency[EM0].entries++;
+		decision_stats[mode].decisions++;
+		if(mode != allowed){
+			decision_stats[mode].demoted++;
+		}
+		if(predicted){
+			decision_stats[mode].predicted++;
+		}
 	}
 
 	CORE_EXIT_CRITICAL();
-	return;
 }
 
 /***************************************************************************//**
  * @brief
- *	Returns the lowest energy state the processor can be operating in.
+ *	Returns the shallowest energy mode that is blocked.
  *
  * @details
- * 	Iterates through the static array to find which energy mode is allowed based
- * 	on the values in the array. When finding where in the array the first nonzero
- * 	value is, returns the value of the iterator.
+ * 	EM0 is the top bit of the blocked mode bitmask, so counting its leading zeros
+ * 	gives the shallowest blocked mode in one instruction. If no mode is blocked,
+ * 	returns the deepest energy mode.
  *
  ******************************************************************************/
 uint32_t current_block_energy_mode(void){
-	for(uint32_t i; i < MAX_ENERGY_MODES; i++){
-		if(lowest_energy_mode[i] != 0){
-			return i;
-		}
+	uint32_t lowest = __CLZ(blocked_mask);
+
+	if(lowest < MAX_ENERGY_MODES){
+		return lowest;
 	}
 	return (MAX_ENERGY_MODES -1);
 }
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the deepest energy mode the processor is allowed to enter.
+ *
+ * @details
+ * 	This is the mode just above the shallowest blocked mode, or EM0 if EM0 or EM1
+ * 	is blocked, since EM0 is the shallowest mode there is. If no mode is blocked,
+ * 	returns EM4.
+ *
+ ******************************************************************************/
+uint32_t sleep_deepest_allowed(void){
+	uint32_t lowest = __CLZ(blocked_mask);
+
+	if(lowest >= MAX_ENERGY_MODES){
+		return EM4;
+	}
+	if(lowest == EM0){
+		return EM0;
+	}
+	return lowest - 1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the sleep decision counters of an energy mode.
+ *
+ * @param[in] EM
+ *  The energy mode, EM1 to EM3 are the modes entered by the tickless idle.
+ *
+ * @param[out] stats
+ *  Pointer to the struct the counters are copied to.
+ *
+ ******************************************************************************/
+void sleep_decision_stats(uint32_t EM, SLEEP_DECISION_STATS *stats){
+	EFM_ASSERT(EM < MAX_ENERGY_MODES);
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	*stats = decision_stats[EM];
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Clears the sleep decision counters of every energy mode.
+ *
+ ******************************************************************************/
+void sleep_decision_reset(void){
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		decision_stats[i].decisions = 0;
+		decision_stats[i].demoted = 0;
+		decision_stats[i].predicted = 0;
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the measured latency and break-even time of an energy mode.
+ *
+ * @details
+ *	Until the mode has been entered, the latency is zero and the break-even
+ *	time comes from the datasheet wakeup time alone.
+ *
+ * @param[in] EM
+ *  The energy mode, EM1 to EM3 are the modes entered by the tickless idle.
+ *
+ * @param[out] lat
+ *  Pointer to the struct the latency is copied to.
+ *
+ ******************************************************************************/
+void sleep_latency(uint32_t EM, SLEEP_LATENCY *lat){
+	EFM_ASSERT(EM < MAX_ENERGY_MODES);
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	*lat = latency[EM];
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the moving average of the recent sleep lengths in us.
+ *
+ * @details
+ *	Sleeps are timed on the 1 ms software timer tick, so a single short sleep
+ *	is counted as 0 or 1 ms, but the average of many is accurate.
+ *
+ ******************************************************************************/
+uint32_t sleep_idle_average_us(void){
+	return idle_avg_us;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the time spent in an energy mode and the number of times it was entered.
+ *
+ * @details
+ *	The time of EM0 includes the time the core has been awake since it last
+ *	woke up, so the residency of every mode adds up to sleep_residency_elapsed().
+ *
+ * @param[in] EM
+ *  The energy mode, EM0 to EM3 are the modes used by the tickless idle.
+ *
+ * @param[out] res
+ *  Pointer to the struct the residency is copied to.
+ *
+ ******************************************************************************/
+void sleep_residency(uint32_t EM, SLEEP_RESIDENCY *res){
+	EFM_ASSERT(EM < MAX_ENERGY_MODES);
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	*res = residency[EM];
+	if(EM == EM0){
+		res->ticks += sw_timer_now() - awake_since;
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the software timer ticks since the residency was last reset.
+ *
+ ******************************************************************************/
+uint32_t sleep_residency_elapsed(void){
+	return sw_timer_now() - residency_start;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Clears the residency of every energy mode and starts timing from now.
+ *
+ * @note
+ *	sleep_open() clears the residency before the RTCC is running, so this must
+ *	be called again once sw_timer_open() has started it.
+ *
+ ******************************************************************************/
+void sleep_residency_reset(void){
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		residency[i].entries = 0;
+		residency[i].ticks = 0;
+	}
+	residency_start = sw_timer_now();
+	awake_since = residency_start;
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Test Driven Development routine for the energy mode arbiter.
+ *
+ * @details
+ *	Runs SLEEP_ARBITER_TEST_STEPS random blocks and unblocks, chosen by a 16 bit
+ *	LFSR, against a reference copy of the arbiter as it was written before the
+ *	bitmask, which walks an array of block counts. After every step the shallowest
+ *	blocked mode and the mode the tickless idle would allow with no deadline must
+ *	match the reference, along with the counts kept by the test's owner. A mode is
+ *	never blocked SLEEP_MAX_BLOCKS times, and a mode is only unblocked when the
+ *	test holds a block on it, since any other unblock asserts.
+ *
+ * @note
+ *	The block counts of the drivers are saved and restored, and the test runs
+ *	with interrupts disabled so no driver changes them part way through. The
+ *	test's owner is left registered holding no blocks.
+ *
+ ******************************************************************************/
+void sleep_arbiter_test(void){
+	static SLEEP_OWNER test_owner;
+	uint32_t saved_count[MAX_ENERGY_MODES];
+	uint32_t saved_mask;
+	int ref_count[MAX_ENERGY_MODES];
+	uint32_t ref_block;
+	uint32_t ref_allowed;
+	uint32_t allowed;
+	uint16_t lfsr = 0xACE1;
+	uint32_t EM;
+
+	sleep_owner_register(&test_owner, "test", SLEEP_HOLD_UNLIMITED);
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	saved_mask = blocked_mask;
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		saved_count[i] = block_count[i];
+		block_count[i] = 0;
+		ref_count[i] = 0;
+	}
+	blocked_mask = 0;
+
+	for(uint32_t step = 0; step < SLEEP_ARBITER_TEST_STEPS; step++){
+		lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+		EM = lfsr % MAX_ENERGY_MODES;
+		if(ref_count[EM] < SLEEP_MAX_BLOCKS - 1 && (lfsr & 0x100)){
+			sleep_block_mode(&test_owner, EM);
+			ref_count[EM]++;
+		} else if(ref_count[EM] > 0){
+			sleep_unblock_mode(&test_owner, EM);
+			ref_count[EM]--;
+		}
+
+		ref_block = MAX_ENERGY_MODES - 1;
+		for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+			if(ref_count[i] != 0){
+				ref_block = i;
+				break;
+			}
+		}
+		if(ref_count[EM0] > 0 || ref_count[EM1] > 0){
+			ref_allowed = EM0;
+		} else if (ref_count[EM2] > 0){
+			ref_allowed = EM1;
+		} else if (ref_count[EM3] > 0){
+			ref_allowed = EM2;
+		} else {
+			ref_allowed = EM3;
+		}
+
+		allowed = sleep_deepest_allowed();
+		if(allowed > EM3){
+			allowed = EM3;
+		}
+		EFM_ASSERT(current_block_energy_mode() == ref_block);
+		EFM_ASSERT(allowed == ref_allowed);
+		for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+			EFM_ASSERT(block_count[i] == (uint32_t)ref_count[i]);
+			EFM_ASSERT(test_owner.blocks[i] == (uint32_t)ref_count[i]);
+		}
+	}
+
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		block_count[i] = saved_count[i];
+		test_owner.blocks[i] = 0;
+	}
+	test_owner.held = 0;
+	blocked_mask = saved_mask;
+
+	CORE_EXIT_CRITICAL();
+}
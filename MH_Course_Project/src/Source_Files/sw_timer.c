@@ -0,0 +1,361 @@
+/**
+ * @file sw_timer.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Software timers multiplexed on one RTCC compare channel
+ *
+ * @details
+ *  Any number of one-shot and periodic timers share compare channel 1 of the
+ *  RTCC. The active timers are kept in a list sorted by deadline, and the
+ *  compare channel is only ever loaded with the deadline at the head of the
+ *  list, so the core is woken once for the earliest timer and not for every
+ *  timer. The RTCC is clocked from the ULFRCO and keeps counting in EM2 and EM3.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "sw_timer.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static SW_TIMER *timer_head;
+static bool timer_em_blocked;
+static SLEEP_OWNER sw_timer_sleep_owner;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+static void sw_timer_insert(SW_TIMER *timer);
+static bool sw_timer_remove(SW_TIMER *timer);
+static void sw_timer_program(void);
+
+/***************************************************************************//**
+ * @brief
+ *	Adds a timer to the deadline list in order.
+ *
+ * @details
+ *	Deadlines are compared by the sign of their difference, so the order is
+ *	correct across the wrap of the RTCC counter as long as no timer is more than
+ *	half of the counter range away. A timer with the same deadline as timers
+ *	already in the list is placed after them.
+ *
+ * @note
+ *	Must be called from within a critical section.
+ *
+ * @param[in] timer
+ *   Pointer to the timer being added.
+ *
+ ******************************************************************************/
+static void sw_timer_insert(SW_TIMER *timer){
+	SW_TIMER **link = &timer_head;
+
+	while(*link != NULL && (int32_t)((*link)->deadline - timer->deadline) <= 0){
+		link = &(*link)->next;
+	}
+	timer->next = *link;
+	*link = timer;
+	timer->active = true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Removes a timer from the deadline list.
+ *
+ * @note
+ *	Must be called from within a critical section.
+ *
+ * @param[in] timer
+ *   Pointer to the timer being removed.
+ *
+ * @return
+ *   Returns true if the timer was at the head of the list.
+ *
+ ******************************************************************************/
+static bool sw_timer_remove(SW_TIMER *timer){
+	SW_TIMER **link = &timer_head;
+
+	while(*link != NULL && *link != timer){
+		link = &(*link)->next;
+	}
+	timer->active = false;
+	if(*link == NULL){
+		return false;
+	}
+	*link = timer->next;
+	timer->next = NULL;
+	return link == &timer_head;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Loads the compare channel with the earliest deadline.
+ *
+ * @details
+ *	If the deadline has already passed by the time the compare value is
+ *	written, the compare match would not happen until the counter wraps, so
+ *	the interrupt flag is set by software instead. While any timer is active,
+ *	SW_TIMER_EM is blocked since the ULFRCO does not clock the RTCC in EM4.
+ *
+ * @note
+ *	Must be called from within a critical section.
+ *
+ ******************************************************************************/
+static void sw_timer_program(void){
+	if(timer_head == NULL){
+		RTCC_IntDisable(RTCC_IF_CC1);
+		RTCC_IntClear(RTCC_IF_CC1);
+		if(timer_em_blocked){
+			timer_em_blocked = false;
+			sleep_unblock_mode(&sw_timer_sleep_owner, SW_TIMER_EM);
+		}
+		return;
+	}
+	if(!timer_em_blocked){
+		timer_em_blocked = true;
+		sleep_block_mode(&sw_timer_sleep_owner, SW_TIMER_EM);
+	}
+	RTCC_ChannelCCVSet(SW_TIMER_CC, timer_head->deadline);
+	RTCC_IntEnable(RTCC_IF_CC1);
+	if((int32_t)(timer_head->deadline - RTCC_CounterGet()) <= 0){
+		RTCC_IntSet(RTCC_IF_CC1);
+	}
+}
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Opens the RTCC as the time base of the software timers.
+ *
+ * @details
+ *	The RTCC counts LFE clock ticks without a prescaler, so with the LFE clock
+ *	tree routed to the ULFRCO in cmu_open() one tick is one millisecond. Compare
+ *	channel 1 is used so that channel 0 stays free.
+ *
+ * @note
+ *	cmu_open() must be called first to route the LFE clock tree.
+ *
+ ******************************************************************************/
+void sw_timer_open(void){
+	RTCC_Init_TypeDef rtcc_init = RTCC_INIT_DEFAULT;
+	RTCC_CCChConf_TypeDef rtcc_compare = RTCC_CH_INIT_COMPARE_DEFAULT;
+
+	CMU_ClockEnable(cmuClock_RTCC, true);
+
+	timer_head = NULL;
+	timer_em_blocked = false;
+	sleep_owner_register(&sw_timer_sleep_owner, "sw_timer", SLEEP_HOLD_UNLIMITED);
+
+	rtcc_init.enable = false;
+	rtcc_init.debugRun = false;
+	rtcc_init.presc = rtccCntPresc_1;
+	RTCC_Init(&rtcc_init);
+	RTCC_ChannelInit(SW_TIMER_CC, &rtcc_compare);
+
+	RTCC_IntDisable(_RTCC_IEN_MASK);
+	RTCC_IntClear(_RTCC_IF_MASK);
+	NVIC_EnableIRQ(RTCC_IRQn);
+
+	RTCC_Enable(true);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Starts a one-shot or periodic software timer.
+ *
+ * @details
+ *	If the timer is already running it is restarted with the new settings. The
+ *	compare channel is only reloaded if the timer becomes the earliest deadline.
+ *
+ * @note
+ *	The timer struct must stay valid until the timer has expired or has been
+ *	stopped, since it is linked into the deadline list.
+ *
+ * @param[in] timer
+ *   Pointer to the timer being started.
+ *
+ * @param[in] event
+ *   The scheduler event posted each time the timer expires, or SCHEDULER_NO_EVENT.
+ *
+ * @param[in] delay_ms
+ *   Milliseconds until the first expiration.
+ *
+ * @param[in] period_ms
+ *   Milliseconds between expirations after the first, or 0 for a one-shot timer.
+ *
+ ******************************************************************************/
+void sw_timer_start(SW_TIMER *timer, uint32_t event, uint32_t delay_ms, uint32_t period_ms){
+	bool was_head;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	was_head = false;
+	if(timer->active){
+		was_head = sw_timer_remove(timer);
+	}
+	timer->deadline = RTCC_CounterGet() + delay_ms * SW_TIMER_HZ / 1000;
+	timer->period = period_ms * SW_TIMER_HZ / 1000;
+	timer->event = event;
+	timer->count = 0;
+	sw_timer_insert(timer);
+	if(was_head || timer_head == timer){
+		sw_timer_program();
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Stops a software timer.
+ *
+ * @details
+ *	Stopping a timer that is not running has no effect. The compare channel
+ *	is only reloaded if the timer was the earliest deadline.
+ *
+ * @param[in] timer
+ *   Pointer to the timer being stopped.
+ *
+ ******************************************************************************/
+void sw_timer_stop(SW_TIMER *timer){
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	if(timer->active && sw_timer_remove(timer)){
+		sw_timer_program();
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the current time of the software timers in RTCC ticks.
+ *
+ ******************************************************************************/
+uint32_t sw_timer_now(void){
+	return RTCC_CounterGet();
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the earliest deadline of the active software timers.
+ *
+ * @param[out] deadline
+ *   The RTCC tick of the earliest deadline.
+ *
+ * @return
+ *   Returns false if no timer is active.
+ *
+ ******************************************************************************/
+bool sw_timer_next_deadline(uint32_t *deadline){
+	bool active;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	active = (timer_head != NULL);
+	if(active){
+		*deadline = timer_head->deadline;
+	}
+
+	CORE_EXIT_CRITICAL();
+	return active;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Interrupt handler for the RTCC.
+ *
+ * @details
+ *	Every timer at the head of the list whose deadline has passed is removed
+ *	and its event is posted to the scheduler. A periodic timer is put back in
+ *	the list one period after its previous deadline, so that it does not drift
+ *	by the interrupt latency. The compare channel is then loaded with the new
+ *	earliest deadline.
+ *
+ ******************************************************************************/
+void RTCC_IRQHandler(void){
+	uint32_t int_flag;
+	uint32_t now;
+	SW_TIMER *timer;
+
+	int_flag = RTCC->IF & RTCC->IEN;
+	RTCC->IFC = int_flag;
+	if(int_flag & RTCC_IF_CC1){
+		now = RTCC_CounterGet();
+		while(timer_head != NULL && (int32_t)(timer_head->deadline - now) <= 0){
+			timer = timer_head;
+			timer_head = timer->next;
+			timer->next = NULL;
+			timer->active = false;
+			timer->count++;
+			if(timer->event != SCHEDULER_NO_EVENT){
+				add_scheduled_event(timer->event);
+			}
+			if(timer->period){
+				timer->deadline += timer->period;
+				sw_timer_insert(timer);
+			}
+		}
+		sw_timer_program();
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Test Driven Development routine for the software timers.
+ *
+ * @details
+ *	Starts one periodic timer and three one-shot timers out of deadline order
+ *	and checks that the list is sorted, then stops one of the one-shot timers.
+ *	After waiting until just past the fifth expiration of the periodic timer,
+ *	the periodic timer must have expired exactly five times, the remaining
+ *	one-shot timers once each, and the stopped timer never.
+ *
+ * @note
+ *	The timers are started without an event, so nothing is posted to the
+ *	scheduler. This test busy waits for about 50ms.
+ *
+ ******************************************************************************/
+void sw_timer_test(void){
+	static SW_TIMER test_timer[4];
+	uint32_t end;
+
+	sw_timer_start(&test_timer[0], SCHEDULER_NO_EVENT, 25, 0);
+	sw_timer_start(&test_timer[1], SCHEDULER_NO_EVENT, 10, 10);
+	sw_timer_start(&test_timer[2], SCHEDULER_NO_EVENT, 5, 0);
+	sw_timer_start(&test_timer[3], SCHEDULER_NO_EVENT, 30, 0);
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	EFM_ASSERT(timer_head == &test_timer[2]);
+	EFM_ASSERT(test_timer[2].next == &test_timer[1]);
+	EFM_ASSERT(test_timer[1].next == &test_timer[0]);
+	EFM_ASSERT(test_timer[0].next == &test_timer[3]);
+	end = test_timer[1].deadline + 4 * test_timer[1].period;
+	CORE_EXIT_CRITICAL();
+
+	sw_timer_stop(&test_timer[3]);
+	EFM_ASSERT(!test_timer[3].active);
+
+	while((int32_t)(sw_timer_now() - end) <= 0);
+
+	EFM_ASSERT(test_timer[1].count == 5);
+	EFM_ASSERT(test_timer[1].active);
+	EFM_ASSERT(test_timer[0].count == 1 && !test_timer[0].active);
+	EFM_ASSERT(test_timer[2].count == 1 && !test_timer[2].active);
+	EFM_ASSERT(test_timer[3].count == 0);
+
+	sw_timer_stop(&test_timer[1]);
+	EFM_ASSERT(!test_timer[1].active);
+}
@@ -0,0 +1,185 @@
+/**
+ * @file sweep.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Energy mode sweep benchmark
+ *
+ * @details
+ *  Holds the deepest energy mode at each level in turn, from EM0 up, for
+ *  SWEEP_DWELL_MS while the regular sampling keeps running, and records the
+ *  readings completed, the readings missed, the measured wake latency and the
+ *  residency of every energy mode for each level. The application runs the
+ *  dwells and reports the table, so each firmware release can be checked for
+ *  power regressions on the same sweep.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "sweep.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static SLEEP_OWNER sweep_sleep_owner;
+static SWEEP_RESULT results[MAX_ENERGY_MODES];
+static uint32_t start_ticks[MAX_ENERGY_MODES];
+static uint32_t sweep_count;
+static uint32_t sweep_period_ms;
+static uint32_t level;
+static uint32_t readings;
+static bool running;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Opens the sweep and clears its results.
+ *
+ * @param[in] levels
+ *	Number of levels swept, EM0 to EM(levels - 1). Modes the application
+ *	always blocks are left out.
+ *
+ * @param[in] period_ms
+ *	The sampling period, used to work out the readings expected in a dwell.
+ *
+ ******************************************************************************/
+void sweep_open(uint32_t levels, uint32_t period_ms){
+	EFM_ASSERT(levels > 0 && levels < MAX_ENERGY_MODES);
+	EFM_ASSERT(period_ms > 0);
+
+	sleep_owner_register(&sweep_sleep_owner, "sweep", SLEEP_HOLD_UNLIMITED);
+	sweep_count = levels;
+	sweep_period_ms = period_ms;
+	running = false;
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		results[i].readings = 0;
+		results[i].missed = 0;
+		results[i].wake_us = 0;
+		for(uint32_t j = 0; j < MAX_ENERGY_MODES; j++){
+			results[i].percent[j] = 0;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of levels swept.
+ *
+ ******************************************************************************/
+uint32_t sweep_levels(void){
+	return sweep_count;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Starts the dwell of a level, keeping the core out of deeper modes.
+ *
+ * @details
+ *	The next deeper mode is blocked, so EM is the deepest mode the tickless
+ *	idle can choose. It may still choose a shallower one when the idle time is
+ *	too short, which shows in the residency.
+ *
+ * @param[in] EM
+ *	The level, the deepest energy mode allowed during the dwell.
+ *
+ ******************************************************************************/
+void sweep_begin(uint32_t EM){
+	SLEEP_RESIDENCY res;
+
+	EFM_ASSERT(EM < sweep_count && !running);
+
+	level = EM;
+	readings = 0;
+	sleep_block_mode(&sweep_sleep_owner, level + 1);
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		sleep_residency(i, &res);
+		start_ticks[i] = res.ticks;
+	}
+	running = true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Counts a completed reading towards the level being swept.
+ *
+ ******************************************************************************/
+void sweep_reading(void){
+	if(running){
+		readings++;
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Ends the dwell of the level and records its results.
+ *
+ * @details
+ *	The wake latency is the moving average of the exit cycles of the level's
+ *	mode, which follows the sleeps of the dwell, at the current core clock.
+ *	Residency must not be cleared with #SLEEPCLR! during a dwell.
+ *
+ ******************************************************************************/
+void sweep_end(void){
+	SWEEP_RESULT *result = &results[level];
+	SLEEP_RESIDENCY res;
+	SLEEP_LATENCY lat;
+	uint32_t ticks[MAX_ENERGY_MODES];
+	uint32_t total = 0;
+	uint32_t expected;
+	uint32_t mhz;
+
+	EFM_ASSERT(running);
+
+	running = false;
+	sleep_unblock_mode(&sweep_sleep_owner, level + 1);
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		sleep_residency(i, &res);
+		ticks[i] = res.ticks - start_ticks[i];
+		total += ticks[i];
+	}
+	if(total == 0){
+		total = 1;
+	}
+	for(uint32_t i = 0; i < MAX_ENERGY_MODES; i++){
+		result->percent[i] = (uint64_t)ticks[i] * 100 / total;
+	}
+
+	expected = SWEEP_DWELL_MS / sweep_period_ms;
+	result->readings = readings;
+	result->missed = expected > readings ? expected - readings : 0;
+
+	sleep_latency(level, &lat);
+	mhz = perf_core_hz() / 1000000;
+	if(mhz == 0){
+		mhz = 1;
+	}
+	result->wake_us = lat.exit_cycles / mhz;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the results of a level.
+ *
+ * @param[in] EM
+ *	The level.
+ *
+ * @param[out] result
+ *	Pointer to the struct the results are copied to.
+ *
+ ******************************************************************************/
+void sweep_result(uint32_t EM, SWEEP_RESULT *result){
+	EFM_ASSERT(EM < MAX_ENERGY_MODES);
+
+	*result = results[EM];
+}
@@ -0,0 +1,163 @@
+/**
+ * @file task.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Cooperative stackless tasks run by the scheduler
+ *
+ * @details
+ *  A task is a function that can wait part way through for a delay or for a
+ *  scheduler event and then carry on where it left off, using the macros in
+ *  task.h. Each task is run by the handler of its own scheduler event, so a
+ *  waiting task costs nothing and the core can sleep until the task's timer
+ *  expires or the event it waits on is dispatched.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "task.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static TASK *task_list;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+static void task_dispatch_hook(uint32_t event);
+
+/***************************************************************************//**
+ * @brief
+ *	Wakes the tasks that are waiting on a scheduler event.
+ *
+ * @details
+ *	Called by the scheduler as each event is dispatched, before the event's
+ *	handler runs. A task that is waiting on the event is marked and its own
+ *	event is posted, so it resumes after the handler has run.
+ *
+ * @param[in] event
+ *   The handle of the event being dispatched.
+ *
+ ******************************************************************************/
+static void task_dispatch_hook(uint32_t event){
+	for(TASK *task = task_list; task != NULL; task = task->next){
+		if(task->running && task->wait_event == event){
+			task->event_seen = true;
+			add_scheduled_event(task->event);
+		}
+	}
+}
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Opens the task facility.
+ *
+ * @note
+ *	Must be called after scheduler_open() and sw_timer_open().
+ *
+ ******************************************************************************/
+void task_open(void){
+	task_list = NULL;
+	scheduler_set_dispatch_hook(task_dispatch_hook);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Sets up a task that is run by a scheduler event.
+ *
+ * @details
+ *	The handler registered for the event must call task_run() with the task.
+ *	The task does not run until task_start() is called.
+ *
+ * @param[in] task
+ *   Pointer to the task, which must stay valid while the task exists.
+ *
+ * @param[in] fn
+ *   The body of the task.
+ *
+ * @param[in] event
+ *   The handle of the scheduler event that runs the task.
+ *
+ ******************************************************************************/
+void task_create(TASK *task, TASK_FN fn, uint32_t event){
+	EFM_ASSERT(fn != NULL);
+	EFM_ASSERT(event != SCHEDULER_NO_EVENT);
+
+	task->fn = fn;
+	task->event = event;
+	task->line = 0;
+	task->wait_event = SCHEDULER_NO_EVENT;
+	task->event_seen = false;
+	task->timed_out = false;
+	task->running = false;
+	task->timer.active = false;
+	task->next = task_list;
+	task_list = task;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Starts a task from the beginning of its body.
+ *
+ * @param[in] task
+ *   Pointer to the task being started.
+ *
+ ******************************************************************************/
+void task_start(TASK *task){
+	sw_timer_stop(&task->timer);
+	task->line = 0;
+	task->wait_event = SCHEDULER_NO_EVENT;
+	task->running = true;
+	add_scheduled_event(task->event);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Runs a task up to its next wait.
+ *
+ * @details
+ *	Called by the handler of the task's scheduler event. The event can be posted
+ *	by the task's timer, by a waited on event being dispatched, or by
+ *	task_signal(), so a task that is not ready yet just checks its wait
+ *	condition again and returns.
+ *
+ * @param[in] task
+ *   Pointer to the task being run.
+ *
+ ******************************************************************************/
+void task_run(TASK *task){
+	if(!task->running){
+		return;
+	}
+	if(task->fn(task)){
+		task->running = false;
+		sw_timer_stop(&task->timer);
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Schedules a running task to check its wait condition again.
+ *
+ * @details
+ *	Used by code that changes the condition a task is waiting on with
+ *	TASK_WAIT_UNTIL. Can be called from an interrupt handler.
+ *
+ * @param[in] task
+ *   Pointer to the task being signalled.
+ *
+ ******************************************************************************/
+void task_signal(TASK *task){
+	if(task->running){
+		add_scheduled_event(task->event);
+	}
+}
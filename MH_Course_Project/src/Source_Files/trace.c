@@ -0,0 +1,177 @@
+/**
+ * @file trace.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Binary event trace kept in a RAM ring buffer
+ *
+ * @details
+ *  The scheduler, sleep routines, I2C and LEUART drivers each record what they
+ *  are doing as an 8 byte record of the cycle count, an ID and one argument.
+ *  The newest TRACE_RECORDS records are kept, overwriting the oldest, so that
+ *  the order of events leading up to a problem can be read back. The trace is
+ *  frozen and sent over BLE in binary packets, and tools/trace_decode.py turns
+ *  the packets back into a timeline.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** Standard Library includes
+#include <string.h>
+
+//** User/developer include files
+#include "trace.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static TRACE_RECORD trace_buf[TRACE_RECORDS];
+static volatile uint32_t trace_head;
+static volatile bool trace_frozen;
+static uint32_t dump_head;
+static uint32_t dump_count;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Clears the trace and starts recording.
+ *
+ * @note
+ *	The records are timed with the DWT cycle counter, which is started by
+ *	scheduler_open().
+ *
+ ******************************************************************************/
+void trace_open(void){
+	trace_head = 0;
+	trace_frozen = false;
+	dump_head = 0;
+	dump_count = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Adds a record to the trace.
+ *
+ * @details
+ *	The slot is claimed by incrementing the head with an exclusive load and
+ *	store, so the function can be called from any interrupt handler without
+ *	masking interrupts, and the oldest record is overwritten once the buffer is
+ *	full. Nothing is recorded while the trace is frozen.
+ *
+ * @note
+ *	An interrupt that records between another caller claiming its slot and
+ *	reading the cycle counter leaves the two records a few cycles out of order.
+ *
+ * @param[in] id
+ *   One of enum trace_ids.
+ *
+ * @param[in] arg
+ *   The argument of the record, as described for the ID.
+ *
+ ******************************************************************************/
+void trace_record(uint16_t id, uint16_t arg){
+	TRACE_RECORD *rec;
+
+	if(trace_frozen){
+		return;
+	}
+	rec = &trace_buf[atomic_word_add(&trace_head, 1) & TRACE_MASK];
+	rec->cycles = DWT->CYCCNT;
+	rec->id = id;
+	rec->arg = arg;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Stops recording so that the trace can be dumped.
+ *
+ * @details
+ *	The records held when the trace is frozen are the ones that are dumped.
+ *
+ ******************************************************************************/
+void trace_freeze(void){
+	trace_frozen = true;
+	dump_head = trace_head;
+	dump_count = (dump_head < TRACE_RECORDS) ? dump_head : TRACE_RECORDS;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Starts recording again after the trace has been dumped.
+ *
+ ******************************************************************************/
+void trace_resume(void){
+	trace_frozen = false;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Writes the next packet of the frozen trace.
+ *
+ * @details
+ *	Every packet starts with TRACE_SYNC and a count of the records it carries.
+ *	The first packet has a count of 0 and carries the version, the number of
+ *	records in the dump and the core clock frequency, so the host can convert
+ *	cycles to time. The packets after it carry up to TRACE_PACKET_RECORDS
+ *	records each, oldest first. All fields are little endian.
+ *
+ * @note
+ *	The trace must be frozen with trace_freeze() before the first packet.
+ *
+ * @param[in] pos
+ *   The packet to write, starting from 0, advanced past the packet written.
+ *
+ * @param[out] packet
+ *   Buffer of at least TRACE_PACKET_SIZE bytes the packet is written to.
+ *
+ * @return
+ *   The length of the packet in bytes, or 0 once every record has been written.
+ *
+ ******************************************************************************/
+uint32_t trace_dump_packet(uint32_t *pos, uint8_t *packet){
+	uint32_t clock;
+	uint32_t first;
+	uint32_t count;
+
+	EFM_ASSERT(trace_frozen);
+
+	packet[0] = TRACE_SYNC;
+	if(*pos == 0){
+		clock = CMU_ClockFreqGet(cmuClock_CORE);
+		packet[1] = 0;
+		packet[2] = TRACE_VERSION;
+		packet[3] = 0;
+		packet[4] = dump_count & 0xFF;
+		packet[5] = dump_count >> 8;
+		memcpy(&packet[6], &clock, sizeof(clock));
+		(*pos)++;
+		return TRACE_INFO_SIZE;
+	}
+
+	first = (*pos - 1) * TRACE_PACKET_RECORDS;
+	if(first >= dump_count){
+		return 0;
+	}
+	count = dump_count - first;
+	if(count > TRACE_PACKET_RECORDS){
+		count = TRACE_PACKET_RECORDS;
+	}
+	packet[1] = count;
+	for(uint32_t i = 0; i < count; i++){
+		memcpy(&packet[TRACE_PACKET_HEADER + i * sizeof(TRACE_RECORD)],
+				&trace_buf[(dump_head - dump_count + first + i) & TRACE_MASK],
+				sizeof(TRACE_RECORD));
+	}
+	(*pos)++;
+	return TRACE_PACKET_HEADER + count * sizeof(TRACE_RECORD);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file watchdog.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Watchdog supervisor fed by the periodic work of the application
+ *
+ * @details
+ *  WDOG0 is only fed once every registered client has checked in on time
+ *  since the last feed. A client is a piece of periodic work, such as a whole
+ *  temperature reading, that checks in each time it completes, so a handler
+ *  or driver state machine that stops making progress, such as a hung I2C
+ *  transaction, stops the feeds and the watchdog resets the device. WDOG0 runs
+ *  from the ULFRCO, so it keeps counting in EM2 and EM3.
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+
+//** User/developer include files
+#include "watchdog.h"
+
+
+//***********************************************************************************
+// Private variables
+//***********************************************************************************
+static volatile uint32_t checked_in;
+static uint32_t client_mask;
+static uint32_t client_count;
+static uint32_t period_ticks[WATCHDOG_MAX_CLIENTS];
+static uint32_t last_checkin[WATCHDOG_MAX_CLIENTS];
+static uint32_t late_checkins[WATCHDOG_MAX_CLIENTS];
+static bool watchdog_running;
+static bool watchdog_reset;
+
+//***********************************************************************************
+// Private functions
+//***********************************************************************************
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+/***************************************************************************//**
+ * @brief
+ *	Sets up WDOG0 without starting it.
+ *
+ * @details
+ *	WDOG0 is clocked from the ULFRCO and runs in EM2 and EM3, and is paused
+ *	while the debugger has the core halted. Whether the last reset was caused
+ *	by the watchdog is read here, before the reset cause is cleared.
+ *
+ * @note
+ *	Must be called after sw_timer_open(), since check ins are timed on the
+ *	software timer clock.
+ *
+ ******************************************************************************/
+void watchdog_open(void){
+	WDOG_Init_TypeDef wdog_init = WDOG_INIT_DEFAULT;
+
+	watchdog_reset = (RMU_ResetCauseGet() & RMU_RSTCAUSE_WDOGRST) != 0;
+	RMU_ResetCauseClear();
+
+	checked_in = 0;
+	client_mask = 0;
+	client_count = 0;
+	watchdog_running = false;
+
+	wdog_init.enable = false;
+	wdog_init.debugRun = false;
+	wdog_init.em2Run = true;
+	wdog_init.em3Run = true;
+	wdog_init.em4Block = false;
+	wdog_init.swoscBlock = false;
+	wdog_init.lock = false;
+	wdog_init.clkSel = wdogClkSelULFRCO;
+	wdog_init.perSel = WATCHDOG_PERIOD;
+	WDOGn_Init(WDOG0, &wdog_init);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Adds a client that must check in for the watchdog to be fed.
+ *
+ * @details
+ *	A check in that comes more than period_ms after the previous one is
+ *	counted as late and does not count towards the next feed, so the period
+ *	must include any jitter of the work being supervised.
+ *
+ * @note
+ *	The watchdog is only fed after the slowest client has checked in, so the
+ *	period of every client must be well under WATCHDOG_TIMEOUT_MS.
+ *
+ * @param[in] period_ms
+ *   The longest time expected between two check ins of the client.
+ *
+ * @return
+ *   The client number to pass to watchdog_checkin().
+ *
+ ******************************************************************************/
+uint32_t watchdog_register(uint32_t period_ms){
+	uint32_t client = client_count;
+
+	EFM_ASSERT(client < WATCHDOG_MAX_CLIENTS);
+	EFM_ASSERT(period_ms < WATCHDOG_TIMEOUT_MS / 2);
+
+	period_ticks[client] = period_ms * SW_TIMER_HZ / 1000;
+	last_checkin[client] = sw_timer_now();
+	late_checkins[client] = 0;
+	client_mask |= 1u << client;
+	client_count++;
+	return client;
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Starts WDOG0 once the supervised work has been started.
+ *
+ * @details
+ *	The period of every client starts from this call, so the boot up self
+ *	tests can take as long as they need before the watchdog is started.
+ *
+ ******************************************************************************/
+void watchdog_start(void){
+	uint32_t now = sw_timer_now();
+
+	EFM_ASSERT(client_count > 0);
+
+	for(uint32_t i = 0; i < client_count; i++){
+		last_checkin[i] = now;
+	}
+	checked_in = 0;
+	watchdog_running = true;
+	WDOGn_Enable(WDOG0, true);
+	WDOGn_Feed(WDOG0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Stops WDOG0, such as before entering EM4 hibernate.
+ *
+ * @details
+ *	Check ins are ignored until watchdog_start() is called again.
+ *
+ ******************************************************************************/
+void watchdog_stop(void){
+	watchdog_running = false;
+	WDOGn_Enable(WDOG0, false);
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Records that a client has completed its periodic work.
+ *
+ * @details
+ *	The client's bit is set in the check in word, and the client that sets the
+ *	last missing bit clears the word and feeds the watchdog. The word is updated
+ *	with exclusive loads and stores, so check ins can come from any context.
+ *
+ * @param[in] client
+ *   The client number returned by watchdog_register().
+ *
+ ******************************************************************************/
+void watchdog_checkin(uint32_t client){
+	uint32_t mask = 1u << client;
+	uint32_t now;
+
+	EFM_ASSERT(client < client_count);
+	if(!watchdog_running){
+		return;
+	}
+
+	now = sw_timer_now();
+	if(now - last_checkin[client] > period_ticks[client]){
+		last_checkin[client] = now;
+		late_checkins[client]++;
+		return;
+	}
+	last_checkin[client] = now;
+
+	if((atomic_word_or(&checked_in, mask) | mask) == client_mask &&
+			atomic_word_and(&checked_in, ~client_mask) == client_mask){
+		WDOGn_Feed(WDOG0);
+		trace_record(TRACE_WDOG_FEED, client);
+	}
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns the number of late check ins of a client.
+ *
+ * @param[in] client
+ *   The client number returned by watchdog_register().
+ *
+ ******************************************************************************/
+uint32_t watchdog_late(uint32_t client){
+	EFM_ASSERT(client < client_count);
+	return late_checkins[client];
+}
+
+/***************************************************************************//**
+ * @brief
+ *	Returns whether the last reset was caused by the watchdog.
+ *
+ ******************************************************************************/
+bool watchdog_caused_reset(void){
+	return watchdog_reset;
+}
@@ -8,6 +8,11 @@ int main(void){
   /* Chip errata */
   CHIP_Init();
 
+  /* Power down the RAM blocks above the retained RAM of the linker script */
+  if((uint32_t)&__ram_retained_end < SRAM_BASE + SRAM_SIZE){
+	  EMU_RamPowerDown((uint32_t)&__ram_retained_end, 0);
+  }
+
   /* Init DCDC regulator and HFXO with kit specific parameters */
   /* Init DCDC regulator and HFXO with kit specific parameters */
   /* Initialize DCDC. Always start in low-noise mode. */
@@ -24,35 +29,22 @@ int main(void){
   CMU_OscillatorEnable(cmuOsc_HFXO, false, false);
 
   /* Call application program to open / initialize all required peripheral */
-  app_peripheral_setup();
-  EFM_ASSERT(get_scheduled_events() & BOOT_UP_CB);
+  if(hibernate_woke()){
+	  app_wake_setup();
+  } else {
+	  app_peripheral_setup();
+	  EFM_ASSERT(get_scheduled_events());
+  }
   /* Infinite blink loop */
   while (1) {
 //	  EMU_EnterEM1();
 	  CORE_DECLARE_IRQ_STATE;
+	  if(background_run(app_idle_ms())) continue;
+	  perf_update();
+	  dcdc_update();
 	  CORE_ENTER_CRITICAL();
-	  if(!get_scheduled_events()) enter_sleep();
+	  if(!get_scheduled_events()) enter_sleep_tickless(app_idle_ms());
 	  CORE_EXIT_CRITICAL();
-	  if(get_scheduled_events() & LETIMER0_UF_CB){
-		  scheduled_letimer0_uf_cb();
-	  }
-	  if(get_scheduled_events() & LETIMER0_COMP0_CB){
-		  scheduled_letimer0_comp0_cb();
-	  }
-	  if(get_scheduled_events() & LETIMER0_COMP1_CB){
-		  scheduled_letimer0_comp1_cb();
-	  }
-	  if(get_scheduled_events() & SI7021_READ_CB){
-		  si7021_temp_done_evt();
-	  }
-	  if(get_scheduled_events() & BOOT_UP_CB){
-		  scheduled_boot_up_cb();
-	  }
-	  if(get_scheduled_events() & BLE_TX_CB){
-		  scheduled_ble_tx_cb();
-	  }
-	  if(get_scheduled_events() & BLE_RX_CB){
-		  scheduled_ble_rx_cb();
-	  }
+	  scheduler_dispatch();
   }
 }
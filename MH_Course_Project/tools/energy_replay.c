@@ -0,0 +1,63 @@
+/**
+ * @file energy_replay.c
+ * @author Matt Hartnett
+ * @date December 4th, 2020
+ * @brief Runs the board's energy model over recorded traces on the host
+ *
+ * @details
+ *  Uses the same energy_model.c and calibration table as the firmware, so the
+ *  estimate for a trace matches what #ENERGY! would report for the same run.
+ *  Each line of the input is one recorded run, as printed by
+ *  trace_decode.py --energy:
+ *
+ *      em0_ms em1_ms em2_ms em3_ms em4_ms i2c_ms leuart_bytes cycles core_kcycles
+ *
+ *  Build and run with:
+ *
+ *      cc -I../src/Header_Files -o energy_replay energy_replay.c ../src/Source_Files/energy_model.c
+ *      python3 trace_decode.py --energy capture.bin | ./energy_replay
+ *
+ */
+
+//***********************************************************************************
+// Include files
+//***********************************************************************************
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "energy_model.h"
+
+//***********************************************************************************
+// Global functions
+//***********************************************************************************
+
+int main(void){
+	const ENERGY_CALIBRATION cal = ENERGY_CAL_BOARD;
+	ENERGY_SAMPLE sample;
+	uint32_t cycles;
+	uint64_t charge;
+	uint32_t ms;
+	uint32_t average_na;
+	char line[256];
+
+	printf("%10s %10s %10s %10s %10s\n", "ms", "nC/cycle", "uJ/cycle", "avg nA", "life h");
+	while(fgets(line, sizeof(line), stdin) != NULL){
+		if(sscanf(line, "%" SCNu32 " %" SCNu32 " %" SCNu32 " %" SCNu32 " %" SCNu32
+				" %" SCNu32 " %" SCNu32 " %" SCNu32 " %" SCNu32,
+				&sample.mode_ms[0], &sample.mode_ms[1], &sample.mode_ms[2],
+				&sample.mode_ms[3], &sample.mode_ms[4], &sample.i2c_ms,
+				&sample.leuart_bytes, &cycles, &sample.core_kcycles) != 9){
+			continue;
+		}
+		if(cycles == 0){
+			cycles = 1;
+		}
+		charge = energy_model_charge_pc(&cal, &sample);
+		ms = energy_model_sample_ms(&sample);
+		average_na = energy_model_average_na(charge, ms);
+		printf("%10" PRIu32 " %10" PRIu64 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 "\n", ms,
+				charge / cycles / 1000, energy_model_uj(&cal, charge / cycles),
+				average_na, energy_model_life_hours(&cal, average_na));
+	}
+	return 0;
+}
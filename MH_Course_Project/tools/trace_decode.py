@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""
+Decodes an event trace dump captured from the BLE link into a timeline.
+
+Send "#TRACE!" to the board and save everything received to a file, then run:
+
+    python3 trace_decode.py capture.bin
+
+The dump is a set of packets that each start with a 0xA5 sync byte and a
+record count. The first packet (count 0) carries the version, the number of
+records and the core clock. Each record is 8 bytes, little endian: the DWT
+cycle count, the record ID and a 16 bit argument. Any text received between
+packets, such as temperature readings, is skipped.
+
+The cycle counter stops while the core sleeps, so the time of each sleep is
+taken from the milliseconds carried by the wake record that follows it. The
+core clock changes with the HFRCO band, so the cycles after each perf record
+are converted with the frequency it carries. Cycles before the first perf
+record are converted with the clock at the time of the dump.
+
+With --energy the trace is summed into one line for energy_replay instead:
+
+    python3 trace_decode.py --energy capture.bin | ./energy_replay
+"""
+
+import struct
+import sys
+
+SYNC = 0xA5
+VERSION = 1
+RECORD = struct.Struct("<IHH")
+INFO = struct.Struct("<BBHI")
+MAX_PACKET_RECORDS = 7
+
+ENERGY_MODES = ["EM0", "EM1", "EM2", "EM3", "EM4"]
+I2C_STATES = ["handshake", "measure_cmd", "confirm_cmd", "RX_MS_byte", "RX_LS_byte", "end_comm"]
+
+
+def event_name(handle):
+    """Scheduler handles are level * 32 + bit + 1."""
+    levels = ["LOW", "NORMAL", "HIGH", "URGENT"]
+    level, bit = divmod(handle - 1, 32)
+    if 0 <= level < len(levels):
+        return "%d (%s bit %d)" % (handle, levels[level], bit)
+    return str(handle)
+
+
+def describe(rec_id, arg):
+    if rec_id == 1:
+        return "post       event " + event_name(arg)
+    if rec_id == 2:
+        return "dispatch   event " + event_name(arg)
+    if rec_id == 3:
+        return "sleep      " + (ENERGY_MODES[arg] if arg < len(ENERGY_MODES) else str(arg))
+    if rec_id == 4:
+        return "wake       after %d ms" % arg
+    if rec_id == 5:
+        return "i2c start  address 0x%02X" % arg
+    if rec_id == 6:
+        return "i2c state  " + (I2C_STATES[arg] if arg < len(I2C_STATES) else str(arg))
+    if rec_id == 7:
+        return "leuart tx  %d bytes" % arg
+    if rec_id == 8:
+        return "leuart tx  done, %d bytes" % arg
+    if rec_id == 9:
+        return "leuart rx  %d bytes" % arg
+    if rec_id == 10:
+        return "wdog feed  by client %d" % arg
+    if rec_id == 11:
+        return "perf       core clock %d kHz" % arg
+    return "unknown id %d arg %d" % (rec_id, arg)
+
+
+def parse(data):
+    """Returns (clock, records) from the last dump in the capture."""
+    dumps = []
+    current = None
+    i = 0
+    while i < len(data):
+        if data[i] != SYNC or i + 1 >= len(data):
+            i += 1
+            continue
+        count = data[i + 1]
+        if count == 0:
+            if i + 2 + INFO.size > len(data):
+                break
+            version, _, expected, clock = INFO.unpack_from(data, i + 2)
+            if version != VERSION:
+                i += 1
+                continue
+            current = (clock, expected, [])
+            dumps.append(current)
+            i += 2 + INFO.size
+        elif count <= MAX_PACKET_RECORDS and current is not None:
+            end = i + 2 + count * RECORD.size
+            if end > len(data):
+                break
+            for n in range(count):
+                current[2].append(RECORD.unpack_from(data, i + 2 + n * RECORD.size))
+            i = end
+        else:
+            i += 1
+    if not dumps:
+        sys.exit("no trace dump found")
+    clock, expected, records = dumps[-1]
+    if len(records) != expected:
+        print("warning: expected %d records, found %d" % (expected, len(records)), file=sys.stderr)
+    return clock, records
+
+
+def energy(clock, records):
+    """Sums the records into the line read by energy_replay: the ms in EM0 to
+    EM4, the ms spent in I2C transactions, the LEUART bytes sent and the number
+    of measurement cycles, counted as completed I2C transactions, and the
+    thousands of core cycles run."""
+    mode_us = [0.0] * len(ENERGY_MODES)
+    i2c_us = 0.0
+    tx_bytes = 0
+    cycles = 0
+    core_cycles = 0
+    time_us = 0.0
+    i2c_start = None
+    sleep_mode = None
+    last = None
+    for stamp, rec_id, arg in records:
+        if last is not None:
+            core_cycles += (stamp - last) & 0xFFFFFFFF
+            awake = ((stamp - last) & 0xFFFFFFFF) * 1e6 / clock
+            mode_us[0] += awake
+            time_us += awake
+        last = stamp
+        if rec_id == 3:
+            sleep_mode = arg
+        elif rec_id == 4 and sleep_mode is not None:
+            if sleep_mode < len(ENERGY_MODES):
+                mode_us[sleep_mode] += arg * 1000.0
+            time_us += arg * 1000.0
+            sleep_mode = None
+        elif rec_id == 5:
+            i2c_start = time_us
+        elif rec_id == 6 and arg == I2C_STATES.index("end_comm") and i2c_start is not None:
+            i2c_us += time_us - i2c_start
+            i2c_start = None
+            cycles += 1
+        elif rec_id == 8:
+            tx_bytes += arg
+        elif rec_id == 11:
+            clock = arg * 1000
+    fields = [round(us / 1000) for us in mode_us] + [round(i2c_us / 1000), tx_bytes, cycles,
+                                                      core_cycles // 1000]
+    print(" ".join(str(f) for f in fields))
+
+
+def main():
+    args = sys.argv[1:]
+    summary = args[:1] == ["--energy"]
+    if summary:
+        args = args[1:]
+    if len(args) != 1:
+        sys.exit("usage: trace_decode.py [--energy] capture.bin")
+    with open(args[0], "rb") as f:
+        clock, records = parse(f.read())
+    if summary:
+        energy(clock, records)
+        return
+
+    print("%d records, core clock %d Hz" % (len(records), clock))
+    print("%12s %10s  %s" % ("time us", "delta us", "record"))
+    time_us = 0.0
+    last = None
+    for cycles, rec_id, arg in records:
+        delta = 0.0
+        if last is not None:
+            delta = ((cycles - last) & 0xFFFFFFFF) * 1e6 / clock
+            if rec_id == 4:
+                delta += arg * 1000.0
+        time_us += delta
+        last = cycles
+        if rec_id == 11:
+            clock = arg * 1000
+        print("%12.1f %10.1f  %s" % (time_us, delta, describe(rec_id, arg)))
+
+
+if __name__ == "__main__":
+    main()